@@ -151,22 +151,255 @@
 //  (a) traditional recursive backtrack:        backtrack_rec()
 //  (b) stack-based non-recursive backtrack:    backtrack_stk()
 //  (c) queue-based non-recursive backtrack:    backtrack_que()
+//  (d) frame-based non-recursive backtrack:    backtrack_frm()
+//  (e) parallel work-stealing backtrack:       backtrack_par()
+//  (f) multi-process sharded backtrack:        backtrack_procs()
+//  (g) memory-bounded queue-based backtrack:   backtrack_bfs()
+//  (h) compact queue-based backtrack:          backtrack_cmp()
+//  (i) iterative deepening backtrack:          backtrack_ids()
+//  (j) memoized frame-based backtrack:         backtrack_memo()
+//
+// and, for when only the number of solutions is needed:
+//
+//  (k) dynamic programming solution count:     count_solutions()
+//  (l) memoized solution count:                count_memo()
+//
+// or for random access to the solutions, in the order of the search:
+//
+//  (m) ranking and unranking of solutions:     solution_index
+//
+// The functions (a), (b) and (c) only differ in their container, so they share
+// the single function template `backtrack()`, which takes the container, the
+// problem to be solved and the destination of the solutions as policies. Other
+// policies then make a Priority Queue or bounded Stack variant, or solve the
+// problem through a constraint (see below) instead of `reject()` & `accept()`.
+//
+// Beyond our example, `queens_problem` (N-Queens) and `sudoku_problem` (9x9
+// Sudoku, with forward checking) are problem policies too, whose state is kept
+// as bitmasks; they serve as benchmarks with known node counts. The latter
+// can also fill the most constrained cell first, and try its least
+// constraining digits first, which cuts its node counts by orders of
+// magnitude.
+//
+// To find any one solution, `backtrack_luby()` tries the children in random
+// order and restarts after growing numbers of nodes (the Luby sequence), so a
+// search which happens to start in a huge subtree without solutions isn't stuck
+// there.
+//
+// The constraints can also be declared with a `constraint_spec` instead of being
+// written by hand as a class, and compiled into a Deterministic Finite Automaton
+// (DFA) by `dfa_constraint`.
+//
+// With millions of solutions, printing them through `std::cout` one at a time
+// takes most of the time, so they can also be handed over in batches to sinks
+// such as `write_sink` (which uses POSIX `write()` with a large buffer) or
+// `mmap_sink` (which writes to a memory-mapped file).
+//
+// When only the first few solutions are needed, a `search_control` can be given
+// to the searches, to stop them as soon as enough solutions were output, or as
+// soon as the search is cancelled.
+//
+// Likewise a `search_stats` can be given to count, for each length, how many
+// candidates were generated, rejected and accepted, along with the peak size
+// of the frontier; `MODE_STATS` prints those counters for several variants.
+//
+// Since the frontier of the frame-based search is just the prefix and one index
+// per level, `backtrack_ckp()` saves it to a checkpoint file periodically and
+// on `SIGTERM`, so a search of hours can be stopped and resumed later.
+//
+// The frontiers, frames and task deques are allocated from an `arena`: large
+// blocks (on huge pages when possible) carved out by bumping a pointer, with
+// freed memory kept for reuse, so the searches don't call `malloc()` as their
+// frontiers grow and shrink. The workers of `backtrack_procs()` search with an
+// arena of their own, which they drop in bulk between shards.
+//
+// -----------------------------------------------------------------------------
+//
+// The Stack version pushes every sibling of a candidate onto the Stack at once,
+// so for each level of depth up to 36 strings are held in memory, each with its
+// own heap allocation.
+//
+// The frame-based version avoids this by noticing that all the candidates held
+// by the Stack at some level share the same prefix, and differ only by their
+// last character. So instead of the candidates themselves, it stores a single
+// shared prefix buffer and, for each level of depth, one small "frame" holding
+// the index (in `valid_chars`) of the next character to try at that level:
+//
+//  prefix: "b0"            frames: [ 2, 27, 5 ]
+//                                    |   |  |
+//                                    |   |  +-- next child to try is "b0f"
+//                                    |   +----- next sibling of "b0" is "b1"
+//                                    +--------- next sibling of "b" is "c"
+//
+// Memory use is thus proportional to the depth of the search, and no candidate
+// string is ever allocated: a child is made by appending a character to the
+// prefix, and a sibling by overwriting the last character of the prefix.
+//
+// Each frame also holds the "constraint state" of the prefix at its level (in
+// our case: how many digits and letters 'b' were seen so far) so that a child
+// is checked in O(1) from the state of its parent, instead of being rescanned.
+//
+// Finally, a constraint may opt into "lookahead" pruning by telling how many
+// more characters a candidate needs at least, in order to become a solution.
+// If this "deficit" is larger than the number of positions left before the
+// maximum length, the candidate is rejected right away, instead of when its
+// descendants reach the maximum length. For our example the number of nodes
+// checked goes down from ~62 million to ~23 million.
+//
+// Most of those nodes are leaves, so a constraint may also check all the
+// children of a candidate at once, as bitmasks with one bit per character of
+// the alphabet; at the last level, the search then only steps into solutions.
+//
+// Going further, `backtrack_sfx()` lists once per state the suffixes which
+// complete the candidates of the last few levels into solutions, and appends
+// them to the prefix instead of searching those levels at all.
 //
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <iomanip>
 #include <iostream>
-#include <locale>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <new>
 #include <queue>
+#include <random>
 #include <stack>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 namespace
 {
 
+///
+/// @brief Program modes.
+/// @note Uncomment the one you want used, comment all the others.
+/// @note In benchmark mode the solutions are still printed, so the program is
+///  best run as `./backtrack > /dev/null` to see only the timings.
+///
+#define MODE_PRINT
+//#define MODE_BENCHMARK
+//#define MODE_COUNT
+//#define MODE_SAMPLE
+//#define MODE_CHECK
+//#define MODE_STATS
+
+///
+/// @brief Maximum length of a candidate.
+/// @details Candidates of this length have no children.
+///
+constexpr std::size_t max_length(5);
+
+///
+/// @brief Sudoku puzzles for the benchmarks, in row-major order, '.' if empty.
+/// @details The first one was designed to be hard for humans, the second one
+///  has only 17 givens, the fewest a Sudoku with a single solution can have.
+///
+constexpr const char *hard_sudoku(
+    "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1."
+    ".9....4..");
+constexpr const char *sparse_sudoku(
+    ".......1.4.........2...........5.4.7..8...3....1.9....3..4..2...5.1....."
+    "...8.6...");
+
+///
+/// @brief Character classes, as bit flags.
+///
+enum char_class: unsigned char
+{
+    cc_lower    = 1 << 0,   ///< Lowercase latin letter (a-z).
+    cc_digit    = 1 << 1    ///< Decimal digit (0-9).
+};
+
+///
+/// @brief Builds the table of character classes.
+/// @details Unlike `std::islower()` and `std::isdigit()` with a locale, which
+///  look up the locale's facet on every call, the table is built at compile
+///  time and a lookup is a single load.
+/// @returns Table of classes, indexed by character.
+///
+constexpr std::array<unsigned char, UCHAR_MAX + 1> make_char_classes()
+{
+    std::array<unsigned char, UCHAR_MAX + 1> cls{};
+
+    for (const char *p("abcdefghijklmnopqrstuvwxyz"); *p != '\0'; ++p)
+        cls[static_cast<unsigned char>(*p)] |= cc_lower;
+
+    for (const char *p("0123456789"); *p != '\0'; ++p)
+        cls[static_cast<unsigned char>(*p)] |= cc_digit;
+
+    return cls;
+}
+
+///
+/// @brief Table of character classes.
+///
+constexpr std::array<unsigned char, UCHAR_MAX + 1> char_classes(
+    make_char_classes());
+
+///
+/// @brief Returns if a character is a lowercase latin letter (a-z).
+///
+constexpr bool is_lower(char ch)
+{
+    return char_classes[static_cast<unsigned char>(ch)] & cc_lower;
+}
+
+///
+/// @brief Returns if a character is a decimal digit (0-9).
+///
+constexpr bool is_digit(char ch)
+{
+    return char_classes[static_cast<unsigned char>(ch)] & cc_digit;
+}
+
+///
+/// @brief Returns if all characters are lowercase latin letters or digits.
+/// @param [in] p                   Characters to be checked.
+/// @param [in] n                   Number of characters.
+/// @returns Whether or not all characters are valid.
+///
+bool all_valid(const char *p, std::size_t n)
+{
+    for (std::size_t i(0); i < n; ++i)
+        if (char_classes[static_cast<unsigned char>(p[i])] == 0)
+            return false;
+
+    return true;
+}
+
 ///
 /// @brief Returns whether a candidate and its children should be rejected.
 /// @details Rejection occurs if the candidate:
@@ -184,23 +417,13 @@ namespace
 bool reject(const std::string &c)
 try
 {
-    for (char ch: c)
-    {
-        if (!std::islower(ch, std::locale::classic()) &&
-            !std::isdigit(ch, std::locale::classic()))
-        {
-            return true;
-        }
-    }
+    if (!all_valid(c.data(), c.length()))
+        return true;
 
     if (c.length() >= 5)
     {
         if (std::count(c.begin(), c.end(), 'b') < 1 ||
-            std::count_if(c.begin(), c.end(),
-                [](const char &ch) -> bool
-                {
-                    return std::isdigit(ch, std::locale::classic());
-                }) < 2)
+            std::count_if(c.begin(), c.end(), is_digit) < 2)
         {
             return true;
         }
@@ -248,11 +471,7 @@ try
     if (c.length() >= 3 &&
         c.length() <= 5 &&
         std::count(c.begin(), c.end(), 'b') >= 1 &&
-        std::count_if(c.begin(), c.end(),
-            [](const char &ch) -> bool
-            {
-                return std::isdigit(ch, std::locale::classic());
-            }) >= 2)
+        std::count_if(c.begin(), c.end(), is_digit) >= 2)
     {
         return true;
     }
@@ -285,27 +504,60 @@ catch (...)
 const std::string valid_chars("abcdefghijklmnopqrstuvwxyz0123456789");
 
 ///
-/// @brief Retrieves the first child of the candidate.
-/// @details The child is returned as a pointer but must be dereferenced and
-///  stored as a string as soon as it's retrieved, if not null.
-/// @todo Use `std::optional` from C++17 in the future?
+/// @brief Builds the table returned by `char_rank()`.
+/// @returns Table of ranks, indexed by character.
+///
+std::array<std::size_t, UCHAR_MAX + 1> make_char_ranks()
+try
+{
+    std::array<std::size_t, UCHAR_MAX + 1> ranks;
+
+    ranks.fill(std::string::npos);
+
+    for (std::size_t i(0); i < valid_chars.length(); ++i)
+        ranks[static_cast<unsigned char>(valid_chars[i])] = i;
+
+    return ranks;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Returns the rank (index) of a character in `valid_chars`, in O(1).
+/// @param [in] ch                  Character to be looked up.
+/// @returns Rank of the character.
+/// @retval std::string::npos       If the character isn't in `valid_chars`.
+///
+std::size_t char_rank(char ch)
+{
+    static const std::array<std::size_t, UCHAR_MAX + 1> ranks(
+        make_char_ranks());
+
+    return ranks[static_cast<unsigned char>(ch)];
+}
+
+///
+/// @brief Turns the candidate into its first child.
+/// @details The candidate is edited in place, so no memory is allocated as
+///  long as the caller reserved enough capacity for it.
 /// @pre `valid_chars.empty() == false`
-/// @param [in] c                   Candidate for which to get the child.
-/// @returns Pointer to the child.
-/// @retval nullptr                 If there are no children.
+/// @param [in,out] c               Candidate to be turned into its child.
+/// @returns Whether or not the candidate has children.
+/// @retval false                   The candidate was left unchanged.
 ///
-const std::string * first_child(const std::string &c)
+bool first_child(std::string &c)
 try
 {
     assert(valid_chars.empty() == false);
 
-    static std::string child;
-
-    if (c.length() >= 5)
-        return nullptr;
+    if (c.length() >= max_length)
+        return false;
 
-    child = c + valid_chars.front();
-    return &child;
+    c.push_back(valid_chars.front());
+    return true;
 }
 catch (...)
 {
@@ -314,30 +566,42 @@ catch (...)
 }
 
 ///
-/// @brief Retrieves the next sibling of the candidate.
-/// @details The sibling is returned as a pointer but must be dereferenced and
-///  stored as a string as soon as it's retrieved, if not null.
-/// @todo Use `std::optional` from C++17 in the future?
+/// @brief Turns the candidate into its next sibling.
+/// @details The candidate is edited in place. If it has no more siblings, its
+///  last character is removed, which turns it back into its parent; this way
+///  the caller can loop over all children with:
+///
+///      if (first_child(c))
+///          do
+///              /* use c */ ;
+///          while (next_child(c));
+///
 /// @pre `valid_chars.empty() == false`
 /// @pre `c.empty() == false`
-/// @param [in] c                   Candidate for which to get the sibling.
-/// @returns Pointer to the sibling.
-/// @retval nullptr                 If there are no siblings.
+/// @param [in,out] c               Candidate to be turned into its sibling.
+/// @returns Whether or not the candidate had a sibling.
+/// @retval false                   The candidate was turned into its parent.
+/// @throws std::out_of_range       If the last character isn't valid.
 ///
-const std::string * next_child(const std::string &c)
+bool next_child(std::string &c)
 try
 {
     assert(valid_chars.empty() == false);
     assert(c.empty() == false);
 
-    static std::string sibling;
+    const std::size_t rank(char_rank(c.back()));
+
+    if (rank == std::string::npos)
+        throw std::out_of_range("character not in `valid_chars`");
 
-    if (c.back() == valid_chars.back())
-        return nullptr;
+    if (rank + 1 == valid_chars.length())
+    {
+        c.pop_back();
+        return false;
+    }
 
-    sibling = c;
-    sibling.back() = valid_chars.at(valid_chars.find(c.back()) + 1);
-    return &sibling;
+    c.back() = valid_chars[rank + 1];
+    return true;
 }
 catch (const std::out_of_range &e)
 {
@@ -352,141 +616,6450 @@ catch (...)
 }
 
 ///
-/// @brief Performs recursive backtracking.
-/// @param [in] c                   Current candidate to be checked.
+/// @brief Returns the index of the lowest set bit of a non-zero mask.
 ///
-void backtrack_rec(const std::string &c)
-try
+inline unsigned int lowest_bit(std::uint64_t v)
 {
-    if (reject(c))
-        return;
-
-    if (accept(c))
-        std::cout << c << '\n';
+    assert(v != 0);
+#if defined __GNUC__
+    return static_cast<unsigned int>(__builtin_ctzll(v));
+#else
+    unsigned int i(0);
 
-    const std::string *p_child(first_child(c));
-
-    while (p_child != nullptr)
+    while ((v & 1) == 0)
     {
-        const std::string c_child(*p_child);
-
-        backtrack_rec(c_child);
-        p_child = next_child(c_child);
+        v >>= 1;
+        ++i;
     }
+
+    return i;
+#endif
 }
-catch (...)
+
+///
+/// @brief Returns the number of set bits of a mask.
+///
+inline unsigned int bit_count(std::uint64_t v)
 {
-    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
-    throw;
+#if defined __GNUC__
+    return static_cast<unsigned int>(__builtin_popcountll(v));
+#else
+    unsigned int n(0);
+
+    for (; v != 0; v &= v - 1)
+        ++n;
+
+    return n;
+#endif
 }
 
 ///
-/// @brief Performs non-recursive backtracking, using a Stack.
-/// @param [in] start               Beginning candidate, to start with.
+/// @brief Outcome of all the children of a candidate, one bit per character of
+///  the alphabet (bit `i` for `alphabet()[i]`), see `password_constraint`.
 ///
-void backtrack_stk(const std::string &start)
-try
+struct sibling_masks
+{
+    std::uint64_t   rejected;       ///< Rejected, lookahead included.
+    std::uint64_t   accepted;       ///< Accepted.
+};
+
+///
+/// @brief Password constraints, expressed as an incremental constraint state.
+/// @details The functions `reject()` and `accept()` above rescan the whole
+///  candidate at every node, even though a child only differs from its parent
+///  by one character. A constraint state instead summarizes the candidate, and
+///  is updated by one character at a time, so that every check is O(1).
+///
+///  Any class can be used as a constraint by the frame-based backtrack, if it
+///  provides the following members (static or not):
+///
+///      state                          // copyable summary of a candidate
+///      alphabet()                     // characters used to make children
+///      max_length                     // candidates this long are childless
+///      initial()                      // returns the state of ""
+///      step(state, char)              // returns the state of a child
+///      reject(state, length)          // as `reject()` above
+///      accept(state, length)          // as `accept()` above
+///
+///  Optionally, a constraint can opt into lookahead pruning by providing:
+///
+///      lookahead                      // `true` to enable pruning
+///      deficit(state)                 // characters still needed, at least
+///
+///  Optionally, a constraint can allow its solutions to be counted without
+///  being enumerated, if its states are finitely many, by providing:
+///
+///      num_states                     // number of distinct states
+///      index(state)                   // index in [0, num_states) of a state
+///
+///  Optionally, a constraint whose alphabet has at most 64 characters can let
+///  all the children of a candidate be checked at once, with bitwise
+///  operations on masks, by providing:
+///
+///      siblings(state, length)        // returns the `sibling_masks` of the
+///                                     // children of a candidate
+///
+/// @note The counters saturate at the values required by the constraints,
+///  thus the state remains small no matter how long the candidates are.
+/// @tparam MinLength               Minimum length of a password.
+/// @tparam MaxLength               Maximum length of a password.
+/// @tparam Lookahead               Whether or not to use lookahead pruning.
+///
+template <std::size_t MinLength, std::size_t MaxLength, bool Lookahead = true>
+struct password_constraint
 {
-    std::stack<std::string> stk;
+    static constexpr bool           lookahead   = Lookahead;
+    static constexpr std::size_t    min_digits  = 2;
+    static constexpr std::size_t    min_bs      = 1;
+    static constexpr std::size_t    min_length  = MinLength;
+    static constexpr std::size_t    max_length  = MaxLength;
+
+    struct state
+    {
+        unsigned char   digits;     ///< Digits seen, up to `min_digits`.
+        unsigned char   bs;         ///< Letters 'b' seen, up to `min_bs`.
+        bool            invalid;    ///< Invalid character seen.
+    };
+
+    static const std::string & alphabet()
+    {
+        return valid_chars;
+    }
 
-    stk.push(start);
+    static state initial()
+    {
+        return state{0, 0, false};
+    }
 
-    while (!stk.empty())
+    static state step(state s, char ch)
     {
-        if (reject(stk.top()))
+        if (is_digit(ch))
         {
-            stk.pop();
-            continue;
+            if (s.digits < min_digits)
+                ++s.digits;
+        }
+        else
+        if (is_lower(ch))
+        {
+            if (ch == 'b' && s.bs < min_bs)
+                ++s.bs;
         }
+        else
+            s.invalid = true;
+
+        return s;
+    }
+
+    static bool reject(const state &s, std::size_t length)
+    {
+        return s.invalid ||
+            (length >= max_length && (s.digits < min_digits || s.bs < min_bs));
+    }
 
-        if (accept(stk.top()))
-            std::cout << stk.top() << '\n';
+    static bool accept(const state &s, std::size_t length)
+    {
+        return length >= min_length && length <= max_length &&
+            s.digits >= min_digits && s.bs >= min_bs;
+    }
 
-        const std::string *p_child(first_child(stk.top()));
+    ///
+    /// @note A character cannot be both a digit and a letter 'b', so the
+    ///  missing digits and letters 'b' add up.
+    ///
+    static std::size_t deficit(const state &s)
+    {
+        return (min_digits - s.digits) + (min_bs - s.bs);
+    }
 
-        stk.pop();
+    static constexpr std::size_t num_states =
+        2 * (min_digits + 1) * (min_bs + 1);
 
-        if (p_child != nullptr)
-        {
-            stk.push(*p_child);
+    static std::size_t index(const state &s)
+    {
+        return (s.invalid * (min_digits + 1) + s.digits) * (min_bs + 1) + s.bs;
+    }
 
-            const std::string *p_sibling(next_child(stk.top()));
+    ///
+    /// @details The state of a child only differs from its parent's by its
+    ///  last character being a digit, a letter 'b', or neither; so the masks
+    ///  of those characters in the alphabet, combined by the parent's state,
+    ///  give the masks of all the children without stepping into any of them.
+    ///
+    static sibling_masks siblings(const state &s, std::size_t length)
+    {
+        struct char_masks
+        {
+            std::uint64_t   all;
+            std::uint64_t   digits;
+            std::uint64_t   bs;
+        };
 
-            while (p_sibling != nullptr)
+        static const char_masks m(
+            []()
             {
-                stk.push(*p_sibling);
-                p_sibling = next_child(stk.top());
-            }
+                char_masks r{0, 0, 0};
+
+                for (std::size_t i(0); i < valid_chars.length(); ++i)
+                {
+                    r.all |= std::uint64_t(1) << i;
+
+                    if (is_digit(valid_chars[i]))
+                        r.digits |= std::uint64_t(1) << i;
+
+                    if (valid_chars[i] == 'b')
+                        r.bs |= std::uint64_t(1) << i;
+                }
+
+                return r;
+            }());
+
+        const std::size_t len(length + 1);
+
+        if (s.invalid || len > max_length)
+            return sibling_masks{m.all, 0};
+
+        const std::uint64_t digits_ok(s.digits >= min_digits ? m.all :
+            s.digits + 1 == min_digits ? m.digits : 0);
+        const std::uint64_t bs_ok(s.bs >= min_bs ? m.all :
+            s.bs + 1 == min_bs ? m.bs : 0);
+        const std::uint64_t ok(digits_ok & bs_ok);
+
+        std::uint64_t rejected(len >= max_length ? m.all & ~ok : 0);
+
+        if constexpr (Lookahead)
+        {
+            //
+            // a child lowers the deficit by one at most, and only if its
+            // last character is one of the missing ones
+            //
+            const std::size_t   d       (deficit(s));
+            const std::size_t   rem     (max_length - len);
+            const std::uint64_t gain    (
+                (s.digits < min_digits ? m.digits : 0) |
+                (s.bs < min_bs ? m.bs : 0));
+
+            if (d > rem + 1)
+                rejected = m.all;
+            else
+            if (d == rem + 1)
+                rejected |= m.all & ~gain;
         }
+
+        return sibling_masks{rejected, len >= min_length ? ok : 0};
     }
+};
+
+///
+/// @brief Tells if a constraint opted into lookahead pruning.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+///
+template <typename Constraint, typename = void>
+struct has_lookahead: std::false_type
+{
+};
+
+template <typename Constraint>
+struct has_lookahead<Constraint, std::void_t<decltype(Constraint::lookahead)>>:
+    std::bool_constant<Constraint::lookahead>
+{
+};
+
+///
+/// @brief Tells if a constraint can check all the children of a candidate at
+///  once.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+///
+template <typename Constraint, typename = void>
+struct has_siblings: std::false_type
+{
+};
+
+template <typename Constraint>
+struct has_siblings<Constraint, std::void_t<decltype(
+    std::declval<const Constraint &>().siblings(
+        std::declval<const typename Constraint::state &>(), std::size_t()))>>:
+    std::true_type
+{
+};
+
+///
+/// @brief Returns whether a candidate and its children should be rejected.
+/// @details Besides the rejection done by the constraint itself, this function
+///  also performs lookahead pruning if the constraint opted into it.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] s                   State of the candidate.
+/// @param [in] length              Length of the candidate.
+/// @returns Whether or not rejection has occurred.
+///
+template <typename Constraint>
+bool reject(const Constraint &con, const typename Constraint::state &s,
+    std::size_t length)
+{
+    if (con.reject(s, length))
+        return true;
+
+    if constexpr (has_lookahead<Constraint>::value)
+        return con.deficit(s) > con.max_length - length;
+    else
+        return false;
 }
-catch (...)
+
+///
+/// @brief Returns the constraint state of a candidate.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] c                   Candidate.
+/// @returns State of the candidate.
+///
+template <typename Constraint>
+typename Constraint::state state_of(const Constraint &con, const std::string &c)
 {
-    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
-    throw;
+    typename Constraint::state s(con.initial());
+
+    for (char ch: c)
+        s = con.step(s, ch);
+
+    return s;
 }
 
 ///
-/// @brief Performs non-recursive backtracking, using a Queue.
-/// @warning This function is very memory intensive!
-/// @param [in] start               Beginning candidate, to start with.
+/// @brief Declarative specification of constraints.
+/// @details Instead of writing a constraint class by hand, constraints can be
+///  declared with this specification, then compiled into a `dfa_constraint`.
 ///
-void backtrack_que(const std::string &start)
-try
+struct constraint_spec
 {
-    std::queue<std::string> que;
+    ///
+    /// @brief Requirement of at least `count` characters from `chars`.
+    ///
+    struct at_least
+    {
+        std::size_t     count;
+        std::string     chars;
+    };
 
-    que.push(start);
+    std::string                 alphabet;   ///< Allowed characters.
+    std::size_t                 min_length; ///< Minimum length of a solution.
+    std::size_t                 max_length; ///< Maximum length of a solution.
+    std::vector<at_least>       classes;    ///< Required character classes.
+    std::vector<std::string>    forbidden;  ///< Forbidden substrings.
+};
 
-    while (!que.empty())
+///
+/// @brief Constraint compiled from a `constraint_spec` into a Deterministic
+///  Finite Automaton (DFA).
+/// @details A state of the automaton stands for the counters of the required
+///  character classes (saturated at the required counts) together with a node
+///  of an Aho-Corasick automaton, which tracks the forbidden substrings. So
+///  stepping into a child costs a single table lookup.
+///
+///  All the candidates which contain a forbidden substring, or a character not
+///  in the alphabet, go to the "dead" state `0`. Moreover, for every state the
+///  least number of characters needed to reach an accepting state is computed
+///  up front, and candidates which cannot reach one before the maximum length
+///  are rejected, so lookahead pruning comes for free.
+///
+class dfa_constraint
+{
+public:
+
+    using state = std::uint32_t;
+
+    ///
+    /// @brief Compiles a specification.
+    /// @param [in] spec            Specification of the constraints.
+    /// @throws std::invalid_argument If the specification is invalid.
+    ///
+    [[maybe_unused]] explicit dfa_constraint(const constraint_spec &spec);
+
+    const std::string & alphabet() const
     {
-        if (reject(que.front()))
-        {
-            que.pop();
-            continue;
-        }
+        return alpha;
+    }
 
-        if (accept(que.front()))
-            std::cout << que.front() << '\n';
+    state initial() const
+    {
+        return start;
+    }
 
-        const std::string *p_child(first_child(que.front()));
+    state step(state s, char ch) const
+    {
+        return trans[s * (UCHAR_MAX + 1) + static_cast<unsigned char>(ch)];
+    }
 
-        que.pop();
+    bool reject(state s, std::size_t length) const
+    {
+        return length > max_length || dist[s] > max_length - length;
+    }
 
-        if (p_child != nullptr)
-        {
-            que.push(*p_child);
+    bool accept(state s, std::size_t length) const
+    {
+        return length >= min_length && length <= max_length && dist[s] == 0;
+    }
 
-            const std::string *p_sibling(next_child(que.back()));
+    std::size_t index(state s) const
+    {
+        return s;
+    }
 
-            while (p_sibling != nullptr)
-            {
-                que.push(*p_sibling);
-                p_sibling = next_child(que.back());
-            }
-        }
+    ///
+    /// @pre `alpha.length() <= 64`
+    ///
+    sibling_masks siblings(state s, std::size_t length) const
+    {
+        const std::size_t len(length + 1);
+
+        if (len > max_length)
+            return sibling_masks{all, 0};
+
+        const std::uint64_t *const w(&within[s * (max_length + 1)]);
+
+        return sibling_masks{all & ~w[max_length - len],
+            len >= min_length ? w[0] : 0};
     }
-}
-catch (...)
-{
-    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
-    throw;
-}
 
-} // unnamed namespace
+    std::string                 alpha;
+    std::size_t                 min_length;
+    std::size_t                 max_length;
+    std::size_t                 num_states;
 
-///
-/// @brief Enters the program.
-/// @returns Whether or not the operation was successful.
-/// @retval EXIT_SUCCESS            Operation success.
-/// @retval EXIT_FAILURE            Operation failure.
-///
-int main()
-try
+private:
+
+    state                       start;
+    std::vector<state>          trans;  ///< Next states, by state and char.
+    std::vector<std::size_t>    dist;   ///< Characters to accepting state.
+    std::vector<std::uint64_t>  within; ///< Children at most `r` characters
+                                        ///< from an accepting state, by state
+                                        ///< and `r`; if `alpha` fits 64 bits.
+    std::uint64_t               all;    ///< Mask of the whole alphabet.
+};
+
+dfa_constraint::dfa_constraint(const constraint_spec &spec)
+try:
+    alpha(spec.alphabet),
+    min_length(spec.min_length),
+    max_length(spec.max_length),
+    num_states(0),
+    start(0),
+    all(0)
 {
-    backtrack_rec("");
-//  backtrack_stk("");
-//  backtrack_que(""); // WARN: uses lots of memory!
+    constexpr std::size_t   dead    (0);
+    constexpr std::size_t   chars   (UCHAR_MAX + 1);
+    constexpr std::size_t   inf     (SIZE_MAX);
+
+    std::array<std::size_t, chars> rank;
+
+    rank.fill(std::string::npos);
+
+    for (std::size_t i(0); i < alpha.length(); ++i)
+    {
+        if (rank[static_cast<unsigned char>(alpha[i])] != std::string::npos)
+            throw std::invalid_argument("duplicate character in alphabet");
+
+        rank[static_cast<unsigned char>(alpha[i])] = i;
+    }
+
+    if (alpha.empty() || min_length > max_length)
+        throw std::invalid_argument("empty alphabet or lengths out of order");
+
+    //
+    // build the Aho-Corasick automaton of the forbidden substrings:
+    // a trie of the substrings, with the failure links folded into `go`
+    //
+
+    std::vector<std::vector<std::size_t>>   go      (1,
+        std::vector<std::size_t>(alpha.length(), inf));
+    std::vector<bool>                       bad     (1, false);
+
+    for (const std::string &f: spec.forbidden)
+    {
+        if (f.empty())
+            throw std::invalid_argument("empty forbidden substring");
+
+        if (std::any_of(f.begin(), f.end(),
+            [&rank](char ch) -> bool
+            {
+                return rank[static_cast<unsigned char>(ch)] ==
+                    std::string::npos;
+            }))
+        {
+            continue; // cannot occur in any candidate
+        }
+
+        std::size_t node(0);
+
+        for (char ch: f)
+        {
+            std::size_t &next(go[node][rank[static_cast<unsigned char>(ch)]]);
+
+            if (next == inf)
+            {
+                next = go.size();
+                go.emplace_back(alpha.length(), inf);
+                bad.push_back(false);
+            }
+
+            node = next;
+        }
+
+        bad[node] = true;
+    }
+
+    {
+        std::vector<std::size_t>    fail    (go.size(), 0);
+        std::queue<std::size_t>     que;
+
+        for (std::size_t &next: go[0])
+        {
+            if (next == inf)
+                next = 0;
+            else
+                que.push(next);
+        }
+
+        while (!que.empty())
+        {
+            const std::size_t node(que.front());
+
+            que.pop();
+            bad[node] = bad[node] || bad[fail[node]];
+
+            for (std::size_t r(0); r < alpha.length(); ++r)
+            {
+                std::size_t &next(go[node][r]);
+
+                if (next == inf)
+                    next = go[fail[node]][r];
+                else
+                {
+                    fail[next] = go[fail[node]][r];
+                    que.push(next);
+                }
+            }
+        }
+    }
+
+    //
+    // build the DFA over (class counters..., trie node) tuples, reachable
+    // from the empty candidate; any bad trie node is the dead state
+    //
+
+    using tuple = std::vector<std::size_t>;
+
+    std::map<tuple, state>  ids;
+    std::vector<tuple>      tuples  (1);
+    std::queue<state>       que;
+
+    const auto id_of =
+        [&](const tuple &t) -> state
+        {
+            if (bad[t.back()])
+                return dead;
+
+            const auto ins(ids.emplace(t, static_cast<state>(tuples.size())));
+
+            if (ins.second)
+            {
+                tuples.push_back(t);
+                que.push(ins.first->second);
+            }
+
+            return ins.first->second;
+        };
+
+    start = id_of(tuple(spec.classes.size() + 1, 0));
+
+    trans.assign(chars, dead);
+
+    while (!que.empty())
+    {
+        const state s(que.front());
+
+        que.pop();
+        trans.resize(tuples.size() * chars, dead);
+
+        for (std::size_t r(0); r < alpha.length(); ++r)
+        {
+            tuple t(tuples[s]);
+
+            for (std::size_t k(0); k < spec.classes.size(); ++k)
+                if (t[k] < spec.classes[k].count &&
+                    spec.classes[k].chars.find(alpha[r]) != std::string::npos)
+                {
+                    ++t[k];
+                }
+
+            t.back() = go[t.back()][r];
+
+            const state next(id_of(t));
+
+            trans.resize(tuples.size() * chars, dead);
+            trans[s * chars + static_cast<unsigned char>(alpha[r])] = next;
+        }
+    }
+
+    num_states = tuples.size();
+
+    //
+    // find the distance from each state to the nearest accepting state,
+    // by searching backwards from the accepting states
+    //
+
+    std::vector<std::vector<state>> from(num_states);
+
+    dist.assign(num_states, inf);
+
+    for (state s(1); s < num_states; ++s)
+    {
+        for (char ch: alpha)
+            from[step(s, ch)].push_back(s);
+
+        bool ok(true);
+
+        for (std::size_t k(0); k < spec.classes.size(); ++k)
+            ok = ok && tuples[s][k] >= spec.classes[k].count;
+
+        if (ok)
+        {
+            dist[s] = 0;
+            que.push(s);
+        }
+    }
+
+    while (!que.empty())
+    {
+        const state s(que.front());
+
+        que.pop();
+
+        for (state p: from[s])
+            if (p != dead && dist[p] == inf)
+            {
+                dist[p] = dist[s] + 1;
+                que.push(p);
+            }
+    }
+
+    //
+    // for `siblings()`, mask the children of each state by how far they are
+    // from an accepting state
+    //
+    if (alpha.length() > 64)
+        return;
+
+    within.assign(num_states * (max_length + 1), 0);
+
+    for (std::size_t i(0); i < alpha.length(); ++i)
+    {
+        const std::uint64_t bit(std::uint64_t(1) << i);
+
+        all |= bit;
+
+        for (state s(0); s < num_states; ++s)
+            for (std::size_t r(dist[step(s, alpha[i])]); r <= max_length; ++r)
+                within[s * (max_length + 1) + r] |= bit;
+    }
+}
+catch (const std::invalid_argument &e)
+{
+    std::cerr << "`std::invalid_argument` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Returns the specification of the password constraints.
+/// @details Same constraints as `password_constraint`, meant to be compiled
+///  into a `dfa_constraint`.
+/// @param [in] min_length          Minimum length of a password.
+/// @param [in] max_length          Maximum length of a password.
+/// @returns Specification of the constraints.
+///
+[[maybe_unused]]
+constraint_spec password_spec(std::size_t min_length, std::size_t max_length)
+{
+    return constraint_spec{valid_chars, min_length, max_length,
+        {{2, "0123456789"}, {1, "b"}}, {}};
+}
+
+///
+/// @brief Control of a running search: a limit on the number of solutions, and
+///  a cancellation token.
+/// @details The searches which take a control check it once per node, and stop
+///  as soon as it's stopped, i.e. when the limit of solutions was reached or
+///  `cancel()` was called. A control can be shared by the threads of a search,
+///  and `cancel()` can be called from any thread.
+///
+class search_control
+{
+public:
+
+    ///
+    /// @brief Creates a control.
+    /// @param [in] limit           Maximum number of solutions to be output.
+    ///
+    explicit search_control(
+        std::uintmax_t limit = std::numeric_limits<std::uintmax_t>::max()):
+        max(limit),
+        stop(limit == 0)
+    {
+    }
+
+    ///
+    /// @brief Returns if the search must stop.
+    ///
+    bool stopped() const
+    {
+        return stop.load(std::memory_order_relaxed);
+    }
+
+    ///
+    /// @brief Stops the search.
+    ///
+    void cancel()
+    {
+        stop.store(true, std::memory_order_relaxed);
+    }
+
+    ///
+    /// @brief Claims the right to output a solution.
+    /// @details Stops the search once the limit is reached.
+    /// @returns Whether or not the solution may be output.
+    ///
+    bool claim()
+    {
+        const std::uintmax_t n(found.fetch_add(1, std::memory_order_relaxed));
+
+        if (n + 1 >= max)
+            cancel();
+
+        return n < max;
+    }
+
+    ///
+    /// @brief Returns the number of solutions output.
+    ///
+    std::uintmax_t solutions() const
+    {
+        return std::min(found.load(std::memory_order_relaxed), max);
+    }
+
+private:
+
+    const std::uintmax_t            max;
+    std::atomic<std::uintmax_t>     found   {0};
+    std::atomic<bool>               stop;
+};
+
+///
+/// @brief Telemetry of a search.
+/// @details Counts, for every length of candidate, how many nodes were
+///  generated (i.e. checked), how many were rejected and how many accepted,
+///  along with the largest number of nodes held by the frontier at once.
+///  Parallel searches keep one instance per thread, and merge them at the end.
+///
+struct search_stats
+{
+    std::vector<std::uintmax_t>     generated;
+    std::vector<std::uintmax_t>     rejected;
+    std::vector<std::uintmax_t>     accepted;
+    std::uintmax_t                  frontier_peak   = 0;
+
+    ///
+    /// @brief Makes room for the counters of candidates up to a length.
+    /// @param [in] max_length      Maximum length of a candidate.
+    ///
+    void resize(std::size_t max_length)
+    {
+        if (generated.size() < max_length + 1)
+        {
+            generated.resize(max_length + 1, 0);
+            rejected.resize(max_length + 1, 0);
+            accepted.resize(max_length + 1, 0);
+        }
+    }
+
+    void frontier(std::uintmax_t size)
+    {
+        frontier_peak = std::max(frontier_peak, size);
+    }
+
+    ///
+    /// @brief Adds the counters of another instance to this one.
+    /// @param [in] other           Instance to be merged.
+    ///
+    void merge(const search_stats &other)
+    {
+        resize(std::max<std::size_t>(other.generated.size(), 1) - 1);
+
+        for (std::size_t i(0); i < other.generated.size(); ++i)
+        {
+            generated[i] += other.generated[i];
+            rejected[i] += other.rejected[i];
+            accepted[i] += other.accepted[i];
+        }
+
+        frontier_peak = std::max(frontier_peak, other.frontier_peak);
+    }
+
+    ///
+    /// @brief Prints the counters, the prune ratio (the share of generated
+    ///  nodes which were rejected), and the peak memory use of the process.
+    /// @param [in,out] os          Output stream.
+    /// @param [in] name            Name of the search.
+    ///
+    void report(std::ostream &os, const char *name) const
+    {
+        std::uintmax_t gen(0), rej(0), acc(0);
+
+        os << name << ":\n";
+        os << std::setw(8) << "length" << std::setw(14) << "generated";
+        os << std::setw(14) << "rejected" << std::setw(14) << "accepted";
+        os << '\n';
+
+        for (std::size_t i(0); i < generated.size(); ++i)
+        {
+            os << std::setw(8) << i << std::setw(14) << generated[i];
+            os << std::setw(14) << rejected[i] << std::setw(14) << accepted[i];
+            os << '\n';
+
+            gen += generated[i];
+            rej += rejected[i];
+            acc += accepted[i];
+        }
+
+        os << std::setw(8) << "total" << std::setw(14) << gen;
+        os << std::setw(14) << rej << std::setw(14) << acc << '\n';
+        os << "prune ratio: " << (gen != 0 ? 100.0 * rej / gen : 0.0) << "%\n";
+        os << "frontier peak: " << frontier_peak << " nodes\n";
+        os << "peak RSS: " << peak_rss() / 1024 << " KB" << std::endl;
+    }
+
+    ///
+    /// @brief Returns the peak Resident Set Size of the process, in bytes.
+    ///
+    static std::uintmax_t peak_rss()
+    {
+        rusage ru;
+
+        if (::getrusage(RUSAGE_SELF, &ru) != 0)
+            return 0;
+
+        return static_cast<std::uintmax_t>(ru.ru_maxrss) * 1024;
+    }
+};
+
+///
+/// @brief Memory pool for the containers of a search, carved out of large
+///  blocks mapped with `mmap()`.
+/// @details Memory is handed out by bumping a pointer through the current
+///  block. Freed memory goes to a free list per size class (powers of two),
+///  from which it is handed out again first, so a frontier which grows and
+///  shrinks keeps reusing the same memory, without any call to `malloc()`.
+///  `reset()` drops everything at once, keeping the blocks for reuse.
+///
+///  Blocks are 2 MB, the size of an x86-64 huge page. They are mapped with
+///  `MAP_HUGETLB` if huge pages were reserved (see `/proc/sys/vm/nr_hugepages`)
+///  and otherwise with normal pages, advised with `MADV_HUGEPAGE` so that the
+///  kernel may back them with Transparent Huge Pages; either way, a frontier
+///  takes few TLB entries.
+/// @warning An arena isn't thread-safe: it must be used by a single thread at
+///  a time, e.g. the thread which owns it, or the holder of a lock.
+///
+class arena
+{
+public:
+
+    static constexpr std::size_t block_size = 2 << 20;
+    static constexpr std::size_t min_size   = alignof(std::max_align_t);
+    static constexpr std::size_t max_size   = block_size / 2;
+
+    ///
+    /// @brief Creates an empty arena; no memory is mapped until needed.
+    /// @param [in] huge_pages      Whether or not to ask for huge pages.
+    ///
+    explicit arena(bool huge_pages = true):
+        huge(huge_pages),
+        hugetlb(huge_pages)
+    {
+    }
+
+    arena(const arena &) = delete;
+    arena & operator = (const arena &) = delete;
+
+    ~arena()
+    {
+        for (char *b: blocks)
+            ::munmap(b, block_size);
+    }
+
+    ///
+    /// @brief Allocates `n` bytes, aligned for any type; requests larger than
+    ///  `max_size` are passed on to `operator new`.
+    /// @throws std::bad_alloc      If no memory can be mapped.
+    ///
+    void * allocate(std::size_t n)
+    {
+        if (n > max_size)
+            return ::operator new(n);
+
+        const std::size_t k(size_class(n));
+
+        if (free_list[k] != nullptr)
+        {
+            free_node *const f(free_list[k]);
+
+            free_list[k] = f->next;
+            return f;
+        }
+
+        if (static_cast<std::size_t>(end - cur) < min_size << k)
+            next_block();
+
+        void *const p(cur);
+
+        cur += min_size << k;
+        return p;
+    }
+
+    ///
+    /// @brief Frees memory from `allocate(n)`, for reuse by this arena.
+    ///
+    void deallocate(void *p, std::size_t n) noexcept
+    {
+        if (n > max_size)
+        {
+            ::operator delete(p);
+            return;
+        }
+
+        const std::size_t k(size_class(n));
+
+        free_list[k] = ::new (p) free_node{free_list[k]};
+    }
+
+    ///
+    /// @brief Frees all the memory at once, keeping the blocks mapped.
+    /// @warning Nothing allocated from the arena may be used afterwards!
+    ///
+    void reset() noexcept
+    {
+        free_list.fill(nullptr);
+        used = 0;
+        cur = end = nullptr;
+    }
+
+private:
+
+    struct free_node
+    {
+        free_node   *next;
+    };
+
+    static constexpr std::size_t num_classes = 17;
+
+    static_assert((min_size << (num_classes - 1)) >= max_size,
+        "size classes must cover up to `max_size`");
+
+    ///
+    /// @brief Returns the index of the smallest size class holding `n` bytes.
+    ///
+    static std::size_t size_class(std::size_t n)
+    {
+        std::size_t k(0);
+
+        while (min_size << k < n)
+            ++k;
+
+        return k;
+    }
+
+    ///
+    /// @brief Moves on to the next block, mapping it if it's a new one. The
+    ///  rest of the current block is left unused.
+    ///
+    void next_block()
+    {
+        if (used == blocks.size())
+        {
+            char *const b(map_block());
+
+            try
+            {
+                blocks.push_back(b);
+            }
+            catch (...)
+            {
+                ::munmap(b, block_size);
+                throw;
+            }
+        }
+
+        cur = blocks[used++];
+        end = cur + block_size;
+    }
+
+    ///
+    /// @brief Maps a block, aligned on its size.
+    ///
+    char * map_block()
+    {
+        constexpr int prot(PROT_READ | PROT_WRITE);
+        constexpr int flags(MAP_PRIVATE | MAP_ANONYMOUS);
+
+#if defined MAP_HUGETLB
+        if (hugetlb)
+        {
+            void *const m(::mmap(nullptr, block_size, prot,
+                flags | MAP_HUGETLB, -1, 0));
+
+            if (m != MAP_FAILED)
+                return static_cast<char *>(m);
+
+            // no huge pages reserved, don't try again
+            hugetlb = false;
+        }
+#endif
+
+        //
+        // map twice the size, and unmap the ends around an aligned block
+        //
+        void *const m(::mmap(nullptr, 2 * block_size, prot, flags, -1, 0));
+
+        if (m == MAP_FAILED)
+            throw std::bad_alloc();
+
+        const std::uintptr_t    addr    (reinterpret_cast<std::uintptr_t>(m));
+        const std::size_t       lead    ((block_size - addr % block_size) %
+            block_size);
+        char *const             b       (static_cast<char *>(m) + lead);
+
+        if (lead != 0)
+            ::munmap(m, lead);
+
+        ::munmap(b + block_size, block_size - lead);
+
+#if defined MADV_HUGEPAGE
+        if (huge)
+            ::madvise(b, block_size, MADV_HUGEPAGE);
+#endif
+
+        return b;
+    }
+
+    std::array<free_node *, num_classes>    free_list   {};
+    std::vector<char *>                     blocks;
+    std::size_t                             used        = 0;
+    char                                    *cur        = nullptr;
+    char                                    *end        = nullptr;
+    const bool                              huge;
+    bool                                    hugetlb;
+};
+
+///
+/// @brief Returns the arena of the calling thread, unmapped when it exits.
+///
+inline arena & thread_arena()
+{
+    thread_local arena a;
+
+    return a;
+}
+
+///
+/// @brief Standard allocator which allocates from an `arena`.
+/// @details The containers using it must abide by the arena's threading rules.
+/// @tparam T                       Element type.
+///
+template <typename T>
+class arena_allocator
+{
+public:
+
+    static_assert(alignof(T) <= arena::min_size, "over-aligned type");
+
+    using value_type                                = T;
+    using propagate_on_container_move_assignment    = std::true_type;
+    using propagate_on_container_swap               = std::true_type;
+
+    arena_allocator(arena &a) noexcept:
+        a(&a)
+    {
+    }
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U> &rhs) noexcept:
+        a(rhs.a)
+    {
+    }
+
+    T * allocate(std::size_t n)
+    {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+            throw std::bad_array_new_length();
+
+        return static_cast<T *>(a->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept
+    {
+        a->deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator == (const arena_allocator<U> &rhs) const noexcept
+    {
+        return a == rhs.a;
+    }
+
+    template <typename U>
+    bool operator != (const arena_allocator<U> &rhs) const noexcept
+    {
+        return a != rhs.a;
+    }
+
+private:
+
+    template <typename U>
+    friend class arena_allocator;
+
+    arena *a;
+};
+
+///
+/// @brief String whose buffer is allocated from an `arena`.
+///
+using arena_string =
+    std::basic_string<char, std::char_traits<char>, arena_allocator<char>>;
+
+///
+/// @brief Queue stored as a list of fixed-size chunks, reused as a ring.
+/// @details Elements are pushed into the last chunk and popped from the first.
+///  Emptied chunks are kept aside and reused for new elements, so once the
+///  queue has reached its largest size, no more memory is allocated. The
+///  chunks are allocated from the `thread_arena()` of the creating thread.
+/// @tparam T                       Element type.
+/// @tparam ChunkSize               Number of elements in a chunk.
+///
+template <typename T, std::size_t ChunkSize = 1 << 14>
+class chunk_queue
+{
+public:
+
+    chunk_queue():
+        mem(thread_arena()),
+        chunks(mem),
+        spare(mem)
+    {
+    }
+
+    bool empty() const
+    {
+        return chunks.empty();
+    }
+
+    const T & front() const
+    {
+        assert(!empty());
+        return chunks.front()[head];
+    }
+
+    void push(const T &v)
+    {
+        if (chunks.empty() || tail == ChunkSize)
+        {
+            if (spare.empty())
+                chunks.emplace_back(ChunkSize, mem);
+            else
+            {
+                chunks.push_back(std::move(spare.back()));
+                spare.pop_back();
+            }
+
+            tail = 0;
+        }
+
+        chunks.back()[tail++] = v;
+    }
+
+    void pop()
+    {
+        assert(!empty());
+
+        if (++head == ChunkSize || (chunks.size() == 1 && head == tail))
+        {
+            spare.push_back(std::move(chunks.front()));
+            chunks.pop_front();
+            head = 0;
+        }
+    }
+
+private:
+
+    using chunk = std::vector<T, arena_allocator<T>>;
+
+    arena                                       &mem;
+    std::deque<chunk, arena_allocator<chunk>>   chunks;
+    std::vector<chunk, arena_allocator<chunk>>  spare;
+    std::size_t                                 head    = 0;
+    std::size_t                                 tail    = 0;
+};
+
+///
+/// @brief Frontier policy of `backtrack()` which uses recursion, thus the
+///  call stack instead of a container.
+/// @tparam Problem                 Problem type, see `backtrack()`.
+///
+template <typename Problem>
+struct call_stack
+{
+    explicit call_stack(const Problem &)
+    {
+    }
+};
+
+///
+/// @brief Frontier policy of `backtrack()` which uses a Stack (Depth-First).
+/// @details Like all the frontiers below, it's allocated from the
+///  `thread_arena()` of the searching thread.
+/// @tparam Problem                 Problem type, see `backtrack()`.
+///
+template <typename Problem>
+class stack_frontier
+{
+public:
+
+    using node = typename Problem::node;
+
+    explicit stack_frontier(const Problem &):
+        v(thread_arena())
+    {
+    }
+
+    bool empty() const
+    {
+        return v.empty();
+    }
+
+    void push(const node &n)
+    {
+        v.push_back(n);
+    }
+
+    node pop()
+    {
+        node n(std::move(v.back()));
+
+        v.pop_back();
+        return n;
+    }
+
+private:
+
+    std::vector<node, arena_allocator<node>> v;
+};
+
+///
+/// @brief Frontier policy of `backtrack()` which uses a Queue (Breadth-First).
+/// @tparam Problem                 Problem type, see `backtrack()`.
+///
+template <typename Problem>
+class queue_frontier
+{
+public:
+
+    using node = typename Problem::node;
+
+    explicit queue_frontier(const Problem &)
+    {
+    }
+
+    bool empty() const
+    {
+        return q.empty();
+    }
+
+    void push(const node &n)
+    {
+        q.push(n);
+    }
+
+    node pop()
+    {
+        node n(q.front());
+
+        q.pop();
+        return n;
+    }
+
+private:
+
+    chunk_queue<node> q;
+};
+
+///
+/// @brief Frontier policy of `backtrack()` which uses a Priority Queue
+///  (Best-First), expanding first the nodes of lowest `priority()`.
+/// @details Nodes of the same priority are expanded in a Depth-First order.
+/// @note The problem must provide a `priority(node)` member.
+/// @tparam Problem                 Problem type, see `backtrack()`.
+///
+template <typename Problem>
+class priority_frontier
+{
+public:
+
+    using node = typename Problem::node;
+
+    explicit priority_frontier(const Problem &prob):
+        prob(prob),
+        pq(std::less<entry>(), heap(thread_arena()))
+    {
+    }
+
+    bool empty() const
+    {
+        return pq.empty();
+    }
+
+    void push(const node &n)
+    {
+        pq.push(entry{prob.priority(n), seq++, n});
+    }
+
+    node pop()
+    {
+        node n(pq.top().n);
+
+        pq.pop();
+        return n;
+    }
+
+private:
+
+    struct entry
+    {
+        std::size_t     priority;
+        std::uintmax_t  seq;
+        node            n;
+
+        bool operator < (const entry &rhs) const
+        {
+            return priority != rhs.priority ?
+                priority > rhs.priority : seq < rhs.seq;
+        }
+    };
+
+    using heap = std::vector<entry, arena_allocator<entry>>;
+
+    const Problem                       &prob;
+    std::priority_queue<entry, heap>    pq;
+    std::uintmax_t                      seq = 0;
+};
+
+///
+/// @brief Frontier policy of `backtrack()` which uses a Stack of fixed
+///  capacity, allocated once, so that memory use is bounded.
+/// @note The problem must provide a `max_frontier()` member, returning the
+///  largest number of nodes a Depth-First frontier can hold.
+/// @tparam Problem                 Problem type, see `backtrack()`.
+///
+template <typename Problem>
+class bounded_frontier
+{
+public:
+
+    using node = typename Problem::node;
+
+    explicit bounded_frontier(const Problem &prob):
+        v(prob.max_frontier(), thread_arena())
+    {
+    }
+
+    bool empty() const
+    {
+        return size == 0;
+    }
+
+    void push(const node &n)
+    {
+        if (size == v.size())
+            throw std::length_error("bounded frontier is full");
+
+        v[size++] = n;
+    }
+
+    node pop()
+    {
+        return v[--size];
+    }
+
+private:
+
+    std::vector<node, arena_allocator<node>>    v;
+    std::size_t                                 size    = 0;
+};
+
+///
+/// @brief Tells if a frontier policy is `call_stack`.
+///
+template <template <typename> class Frontier>
+struct is_call_stack: std::false_type
+{
+};
+
+template <>
+struct is_call_stack<call_stack>: std::true_type
+{
+};
+
+///
+/// @brief Calls `accept()` on a string.
+/// @details Within `string_problem`, `accept` names its member, and `::accept`
+///  names the POSIX socket function, so neither can reach ours.
+///
+inline bool accept_string(const std::string &c)
+{
+    return accept(c);
+}
+
+///
+/// @brief Problem policy of `backtrack()` which uses the functions `reject()`,
+///  `accept()`, `first_child()` and `next_child()` on strings, from above.
+///
+struct string_problem
+{
+    using node = std::string;
+
+    bool reject(const node &n) const
+    {
+        return ::reject(n);
+    }
+
+    bool accept(const node &n) const
+    {
+        return accept_string(n);
+    }
+
+    bool first_child(const node &parent, node &child) const
+    {
+        child = parent;
+        return ::first_child(child);
+    }
+
+    bool next_child(const node &, node &child) const
+    {
+        return ::next_child(child);
+    }
+
+    const node & solution(const node &n) const
+    {
+        return n;
+    }
+
+    std::size_t depth(const node &n) const
+    {
+        return n.length();
+    }
+
+    std::size_t max_frontier() const
+    {
+        return max_length * (valid_chars.length() - 1) + 1;
+    }
+};
+
+///
+/// @brief Problem policy of `backtrack()` which uses a constraint, such as
+///  `password_constraint`, on fixed-capacity candidates.
+/// @details A node holds the candidate's characters, without allocating, along
+///  with its constraint state and the rank of its last character, thus making
+///  children and siblings in O(1).
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @tparam Capacity                Largest maximum length to be supported.
+///
+template <typename Constraint, std::size_t Capacity = Constraint::max_length>
+class candidate_problem
+{
+public:
+
+    struct node
+    {
+        std::array<char, Capacity>  c;      ///< Characters.
+        std::size_t                 len;    ///< Number of characters.
+        std::size_t                 rank;   ///< Rank of the last character.
+        typename Constraint::state  s;      ///< Constraint state.
+    };
+
+    ///
+    /// @brief Creates the problem.
+    /// @param [in] con             Constraint to be satisfied.
+    /// @throws std::length_error   If the maximum length exceeds `Capacity`.
+    ///
+    explicit candidate_problem(const Constraint &con = Constraint()):
+        con(con)
+    {
+        if (con.max_length > Capacity)
+            throw std::length_error("maximum length exceeds capacity");
+    }
+
+    ///
+    /// @brief Returns the node of a candidate.
+    /// @param [in] c               Candidate, at most `Capacity` long.
+    /// @throws std::length_error   If the candidate is too long.
+    ///
+    node make_node(const std::string &c) const
+    {
+        if (c.length() > Capacity)
+            throw std::length_error("candidate exceeds capacity");
+
+        node n{{}, c.length(), 0, state_of(con, c)};
+
+        std::copy(c.begin(), c.end(), n.c.begin());
+        return n;
+    }
+
+    bool reject(const node &n) const
+    {
+        return ::reject(con, n.s, n.len);
+    }
+
+    bool accept(const node &n) const
+    {
+        return con.accept(n.s, n.len);
+    }
+
+    bool first_child(const node &parent, node &child) const
+    {
+        if (parent.len >= con.max_length)
+            return false;
+
+        child = parent;
+        child.c[child.len++] = con.alphabet().front();
+        child.rank = 0;
+        child.s = con.step(parent.s, con.alphabet().front());
+        return true;
+    }
+
+    bool next_child(const node &parent, node &child) const
+    {
+        if (++child.rank == con.alphabet().length())
+            return false;
+
+        child.c[child.len - 1] = con.alphabet()[child.rank];
+        child.s = con.step(parent.s, child.c[child.len - 1]);
+        return true;
+    }
+
+    std::string_view solution(const node &n) const
+    {
+        return std::string_view(n.c.data(), n.len);
+    }
+
+    std::size_t depth(const node &n) const
+    {
+        return n.len;
+    }
+
+    std::size_t priority(const node &n) const
+    {
+        if constexpr (has_lookahead<Constraint>::value)
+            return con.deficit(n.s);
+        else
+            return 0;
+    }
+
+    std::size_t max_frontier() const
+    {
+        return con.max_length * (con.alphabet().length() - 1) + 1;
+    }
+
+private:
+
+    const Constraint con;
+};
+
+///
+/// @brief Performs recursive backtracking, for `backtrack()`.
+/// @returns Number of nodes checked, rejected or not.
+///
+template <typename Problem, typename Sink>
+std::uintmax_t search_call(const Problem &prob,
+    const typename Problem::node &n, Sink &sink, search_control *ctl,
+    search_stats *stats, std::uintmax_t level)
+{
+    std::uintmax_t nodes(1);
+
+    if (stats != nullptr)
+    {
+        stats->resize(prob.depth(n));
+        ++stats->generated[prob.depth(n)];
+        stats->frontier(level);
+    }
+
+    if ((ctl != nullptr && ctl->stopped()) || prob.reject(n))
+    {
+        if (stats != nullptr)
+            ++stats->rejected[prob.depth(n)];
+
+        return nodes;
+    }
+
+    if (prob.accept(n) && (ctl == nullptr || ctl->claim()))
+    {
+        if (stats != nullptr)
+            ++stats->accepted[prob.depth(n)];
+
+        sink(prob.solution(n));
+    }
+
+    typename Problem::node child;
+
+    if ((ctl == nullptr || !ctl->stopped()) && prob.first_child(n, child))
+        do
+            nodes += search_call(prob, child, sink, ctl, stats, level + 1);
+        while ((ctl == nullptr || !ctl->stopped()) &&
+            prob.next_child(n, child));
+
+    return nodes;
+}
+
+///
+/// @brief Performs backtracking, as set by policies.
+/// @details The recursive, Stack-based and Queue-based backtracking functions
+///  only differ in how they store the candidates yet to be checked (the
+///  "frontier") so they share this single implementation, whereby:
+///
+///  - the frontier policy is one of `call_stack`, `stack_frontier`,
+///    `queue_frontier`, `priority_frontier` or `bounded_frontier`,
+///    or any class template with the members:
+///
+///      Frontier(problem)              // creates an empty frontier
+///      empty()                        // returns if the frontier is empty
+///      push(node)                     // adds a node
+///      pop()                          // removes and returns the next node
+///
+///  - the problem policy is one of `string_problem` or `candidate_problem`,
+///    or any class with the members:
+///
+///      node                           // type of a candidate
+///      reject(node)                   // as `reject()` above
+///      accept(node)                   // as `accept()` above
+///      first_child(parent, child)     // makes `child` the first child
+///      next_child(parent, child)      // makes `child` the next sibling
+///      solution(node)                 // returns the solution to be output
+///      depth(node)                    // returns the length of a candidate
+///
+///  - the sink is any callable, which takes the solutions.
+///
+///  As all of these are template parameters, every call is inlined.
+/// @tparam Frontier                Frontier policy.
+/// @tparam Problem                 Problem policy.
+/// @tparam Sink                    Callable type, taking a solution.
+/// @param [in] prob                Problem to be solved.
+/// @param [in] root                Beginning node, to start with.
+/// @param [in] sink                Function to be called for each solution.
+/// @param [in,out] ctl             Control of the search, if any.
+/// @param [in,out] stats           Telemetry of the search, if any; for the
+///                                 `call_stack`, the frontier peak is the
+///                                 deepest recursion.
+/// @returns Number of nodes checked, rejected or not.
+///
+template <template <typename> class Frontier, typename Problem, typename Sink>
+std::uintmax_t backtrack(const Problem &prob,
+    const typename Problem::node &root, Sink &&sink,
+    search_control *ctl = nullptr, search_stats *stats = nullptr)
+try
+{
+    if constexpr (is_call_stack<Frontier>::value)
+        return search_call(prob, root, sink, ctl, stats, 1);
+    else
+    {
+        Frontier<Problem>       frt     (prob);
+        typename Problem::node  child;
+        std::uintmax_t          nodes   (0);
+        std::uintmax_t          size    (1);
+
+        frt.push(root);
+
+        while (!frt.empty() && (ctl == nullptr || !ctl->stopped()))
+        {
+            const typename Problem::node n(frt.pop());
+
+            --size;
+            ++nodes;
+
+            if (stats != nullptr)
+            {
+                stats->resize(prob.depth(n));
+                ++stats->generated[prob.depth(n)];
+            }
+
+            if (prob.reject(n))
+            {
+                if (stats != nullptr)
+                    ++stats->rejected[prob.depth(n)];
+
+                continue;
+            }
+
+            if (prob.accept(n) && (ctl == nullptr || ctl->claim()))
+            {
+                if (stats != nullptr)
+                    ++stats->accepted[prob.depth(n)];
+
+                sink(prob.solution(n));
+            }
+
+            if (prob.first_child(n, child))
+                do
+                {
+                    frt.push(child);
+                    ++size;
+                }
+                while (prob.next_child(n, child));
+
+            if (stats != nullptr)
+                stats->frontier(size);
+        }
+
+        return nodes;
+    }
+}
+catch (const std::length_error &e)
+{
+    std::cerr << "`std::length_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Prints a solution to `std::cout`.
+/// @param [in] sol                 Solution to be printed.
+///
+void print_solution(std::string_view sol)
+{
+    std::cout << sol << '\n';
+}
+
+///
+/// @brief Performs recursive backtracking.
+/// @param [in] start               Beginning candidate, to start with.
+/// @returns Number of nodes checked, rejected or not.
+///
+std::uintmax_t backtrack_rec(const std::string &start)
+{
+    return backtrack<call_stack>(string_problem(), start, print_solution);
+}
+
+///
+/// @brief Performs non-recursive backtracking, using a Stack.
+/// @param [in] start               Beginning candidate, to start with.
+/// @returns Number of nodes checked, rejected or not.
+///
+std::uintmax_t backtrack_stk(const std::string &start)
+{
+    return backtrack<stack_frontier>(string_problem(), start, print_solution);
+}
+
+///
+/// @brief Performs non-recursive backtracking, using a Queue.
+/// @warning This function is very memory intensive!
+/// @param [in] start               Beginning candidate, to start with.
+/// @returns Number of nodes checked, rejected or not.
+///
+std::uintmax_t backtrack_que(const std::string &start)
+{
+    return backtrack<queue_frontier>(string_problem(), start, print_solution);
+}
+
+///
+/// @brief Problem policy of `backtrack()` for the N-Queens puzzle: placing N
+///  queens on an N x N board, so that no two of them attack each other.
+/// @details Queens are placed one row at a time. A node holds the columns and
+///  the two diagonals already attacked as bitmasks, so that the free squares
+///  of the next row are `~(cols | diag1 | diag2)`, and children are only made
+///  on those: no child is ever rejected. A node also holds the free squares
+///  which remain to be tried after its own, so its next sibling is made by
+///  taking the lowest bit of those.
+///
+///  A solution is output as the column of the queen of each row, in base 32
+///  (0-9, then a-v).
+///
+class queens_problem
+{
+public:
+
+    static constexpr unsigned int max_size = 32;
+
+    struct node
+    {
+        std::uint64_t                   cols;   ///< Attacked columns.
+        std::uint64_t                   diag1;  ///< Attacked "\" diagonals.
+        std::uint64_t                   diag2;  ///< Attacked "/" diagonals.
+        std::uint64_t                   rest;   ///< Squares left to try.
+        unsigned int                    row;    ///< Number of queens placed.
+        std::array<char, max_size>      c;      ///< Column of each queen.
+    };
+
+    ///
+    /// @brief Creates the problem.
+    /// @param [in] n               Size of the board.
+    /// @throws std::invalid_argument If the size is 0 or above `max_size`.
+    ///
+    explicit queens_problem(unsigned int n):
+        n(n),
+        mask(n <= max_size ? (std::uint64_t(1) << n) - 1 : 0)
+    {
+        if (n == 0 || n > max_size)
+            throw std::invalid_argument("board size out of range");
+    }
+
+    ///
+    /// @brief Returns the node of the empty board.
+    ///
+    node make_node() const
+    {
+        return node{0, 0, 0, 0, 0, {}};
+    }
+
+    bool reject(const node &) const
+    {
+        return false;
+    }
+
+    bool accept(const node &n) const
+    {
+        return n.row == this->n;
+    }
+
+    bool first_child(const node &parent, node &child) const
+    {
+        if (parent.row == n)
+            return false;
+
+        child.c = parent.c;
+        return place(parent, ~(parent.cols | parent.diag1 | parent.diag2) &
+            mask, child);
+    }
+
+    bool next_child(const node &parent, node &child) const
+    {
+        return place(parent, child.rest, child);
+    }
+
+    std::string_view solution(const node &n) const
+    {
+        return std::string_view(n.c.data(), n.row);
+    }
+
+    std::size_t depth(const node &n) const
+    {
+        return n.row;
+    }
+
+    std::size_t max_frontier() const
+    {
+        return std::size_t(n) * (n - 1) + 1;
+    }
+
+private:
+
+    ///
+    /// @brief Makes a child by placing a queen on the lowest free square.
+    /// @param [in] parent          Parent node.
+    /// @param [in] free            Free squares of the parent's next row.
+    /// @param [out] child          Child node.
+    /// @returns Whether or not there was a free square.
+    ///
+    bool place(const node &parent, std::uint64_t free, node &child) const
+    {
+        if (free == 0)
+            return false;
+
+        const std::uint64_t bit(free & (~free + 1));
+
+        child.c[parent.row] =
+            "0123456789abcdefghijklmnopqrstuv"[lowest_bit(bit)];
+        child.cols = parent.cols | bit;
+        child.diag1 = ((parent.diag1 | bit) << 1) & mask;
+        child.diag2 = (parent.diag2 | bit) >> 1;
+        child.rest = free ^ bit;
+        child.row = parent.row + 1;
+        return true;
+    }
+
+    unsigned int    n;
+    std::uint64_t   mask;
+};
+
+///
+/// @brief Cells sharing a row, a column or a box with a cell of a 9x9 Sudoku,
+///  indexed by cell (in row-major order).
+///
+constexpr std::array<std::array<unsigned char, 20>, 81> make_sudoku_peers()
+{
+    std::array<std::array<unsigned char, 20>, 81> peers{};
+
+    for (unsigned int i(0); i < 81; ++i)
+    {
+        unsigned int k(0);
+
+        for (unsigned int j(0); j < 81; ++j)
+            if (j != i && (j / 9 == i / 9 || j % 9 == i % 9 ||
+                (j / 27 == i / 27 && j % 9 / 3 == i % 9 / 3)))
+            {
+                peers[i][k++] = static_cast<unsigned char>(j);
+            }
+    }
+
+    return peers;
+}
+
+constexpr std::array<std::array<unsigned char, 20>, 81> sudoku_peers(
+    make_sudoku_peers());
+
+///
+/// @brief Problem policy of `backtrack()` for 9x9 Sudoku.
+/// @details A node holds the grid, and the digits already used in each row,
+///  column and box as bitmasks, so that the candidates (the "domain") of an
+///  empty cell are a single expression, always narrowed to the digits still
+///  allowed by every assignment so far. Each child of a node fills one cell
+///  with one of its candidates.
+///
+///  A child is rejected by forward checking: if one of the empty cells which
+///  share a unit with the cell just filled is left without candidates, the
+///  child can't lead to a solution, however deep it would be searched.
+///
+///  Which cell is filled next, and in which order its candidates are tried,
+///  are chosen by the hooks `select()` and `order()`, as set by:
+/// @tparam MostConstrained         Whether or not to fill first the cell with
+///                                 the fewest candidates (Minimum Remaining
+///                                 Values), rather than the first empty cell
+///                                 in row-major order.
+/// @tparam LeastConstraining       Whether or not to try first the candidates
+///                                 which remove the fewest candidates from the
+///                                 empty peers of the cell, rather than the
+///                                 lowest digits.
+///
+template <bool MostConstrained = false, bool LeastConstraining = false>
+class sudoku_problem
+{
+public:
+
+    static constexpr unsigned char  none        = 81;
+    static constexpr std::uint16_t  all_digits  = 0x1ff;
+
+    struct node
+    {
+        std::array<char, 81>            c;      ///< Cells, '.' if empty.
+        std::array<std::uint16_t, 27>   used;   ///< Digits used per unit.
+        std::uint64_t                   next;   ///< Digits left to try, 4
+                                                ///< bits each, 0 ends.
+        unsigned char                   cell;   ///< Cell filled last.
+        unsigned char                   filled; ///< Number of filled cells.
+    };
+
+    ///
+    /// @brief Returns the node of a grid.
+    /// @param [in] grid            81 cells in row-major order, each a digit
+    ///                             1-9, or '.' or '0' if empty.
+    /// @throws std::invalid_argument If the grid is malformed, or two givens
+    ///                             of a unit are the same.
+    ///
+    node make_node(std::string_view grid) const
+    {
+        if (grid.length() != 81)
+            throw std::invalid_argument("grid is not 81 cells long");
+
+        node n{{}, {}, 0, none, 0};
+
+        for (unsigned int i(0); i < 81; ++i)
+        {
+            const char ch(grid[i]);
+
+            if (ch == '.' || ch == '0')
+            {
+                n.c[i] = '.';
+                continue;
+            }
+
+            if (ch < '1' || ch > '9')
+                throw std::invalid_argument("invalid character in grid");
+
+            const std::uint16_t bit(1 << (ch - '1'));
+
+            for (unsigned int u: units(i))
+            {
+                if (n.used[u] & bit)
+                    throw std::invalid_argument("digit repeated in a unit");
+
+                n.used[u] |= bit;
+            }
+
+            n.c[i] = ch;
+            ++n.filled;
+        }
+
+        return n;
+    }
+
+    ///
+    /// @brief Returns if a node fails forward checking.
+    ///
+    bool reject(const node &n) const
+    {
+        if (n.cell == none)
+            return false;
+
+        for (unsigned char p: sudoku_peers[n.cell])
+            if (n.c[p] == '.' && candidates(n, p) == 0)
+                return true;
+
+        return false;
+    }
+
+    bool accept(const node &n) const
+    {
+        return n.filled == 81;
+    }
+
+    bool first_child(const node &parent, node &child) const
+    {
+        const unsigned int i(select(parent));
+
+        if (i == none)
+            return false;
+
+        child = parent;
+        child.cell = static_cast<unsigned char>(i);
+        child.filled = parent.filled + 1;
+        child.next = order(parent, i);
+        return place(parent, child);
+    }
+
+    bool next_child(const node &parent, node &child) const
+    {
+        return place(parent, child);
+    }
+
+    std::string_view solution(const node &n) const
+    {
+        return std::string_view(n.c.data(), n.c.size());
+    }
+
+    std::size_t depth(const node &n) const
+    {
+        return n.filled;
+    }
+
+    std::size_t max_frontier() const
+    {
+        return 81 * 8 + 1;
+    }
+
+private:
+
+    ///
+    /// @brief Returns the row, column and box of a cell, as unit indices.
+    ///
+    static std::array<unsigned int, 3> units(unsigned int i)
+    {
+        return {i / 9, 9 + i % 9, 18 + i / 27 * 3 + i % 9 / 3};
+    }
+
+    static std::uint16_t candidates(const node &n, unsigned int i)
+    {
+        const std::array<unsigned int, 3> u(units(i));
+
+        return ~(n.used[u[0]] | n.used[u[1]] | n.used[u[2]]) & all_digits;
+    }
+
+    ///
+    /// @brief Variable ordering hook: returns the cell to be filled next.
+    /// @param [in] n               Node whose children are to be made.
+    /// @returns Index of the cell, or `none` if no cell is left.
+    ///
+    static unsigned int select(const node &n)
+    {
+        if constexpr (MostConstrained)
+        {
+            unsigned int best(none), fewest(10);
+
+            for (unsigned int i(0); i < 81 && fewest > 1; ++i)
+                if (n.c[i] == '.')
+                {
+                    const unsigned int k(bit_count(candidates(n, i)));
+
+                    if (k < fewest)
+                    {
+                        best = i;
+                        fewest = k;
+                    }
+                }
+
+            return best;
+        }
+        else
+        {
+            //
+            // the cells before the one filled last are all filled already
+            //
+            unsigned int i(n.cell == none ? 0 : n.cell + 1);
+
+            while (i < 81 && n.c[i] != '.')
+                ++i;
+
+            return i;
+        }
+    }
+
+    ///
+    /// @brief Value ordering hook: returns the candidates of a cell, in the
+    ///  order in which they are to be tried.
+    /// @param [in] n               Node whose children are to be made.
+    /// @param [in] i               Cell to be filled.
+    /// @returns Digits, 4 bits each, the first in the lowest bits.
+    ///
+    static std::uint64_t order(const node &n, unsigned int i)
+    {
+        const std::uint16_t     cand    (candidates(n, i));
+        std::array<unsigned, 9> digit;
+        unsigned int            k       (0);
+
+        for (unsigned int d(0); d < 9; ++d)
+            if (cand & (1 << d))
+                digit[k++] = d + 1;
+
+        if constexpr (LeastConstraining)
+        {
+            //
+            // count, for each candidate, the empty peers which have it too,
+            // then sort them by that count (insertion sort, stable)
+            //
+            std::array<unsigned, 9> cost{};
+
+            for (unsigned char p: sudoku_peers[i])
+                if (n.c[p] == '.')
+                {
+                    const std::uint16_t pc(candidates(n, p));
+
+                    for (unsigned int j(0); j < k; ++j)
+                        cost[j] += (pc >> (digit[j] - 1)) & 1;
+                }
+
+            for (unsigned int j(1); j < k; ++j)
+                for (unsigned int m(j); m != 0 && cost[m] < cost[m - 1]; --m)
+                {
+                    std::swap(cost[m], cost[m - 1]);
+                    std::swap(digit[m], digit[m - 1]);
+                }
+        }
+
+        std::uint64_t next(0);
+
+        while (k != 0)
+            next = next << 4 | digit[--k];
+
+        return next;
+    }
+
+    ///
+    /// @brief Fills `child.cell` of the parent with the next digit to try.
+    /// @param [in] parent          Parent node.
+    /// @param [in,out] child       Child node, whose cell and digits to try
+    ///                             are set.
+    /// @returns Whether or not there was a digit left to try.
+    ///
+    bool place(const node &parent, node &child) const
+    {
+        if (child.next == 0)
+            return false;
+
+        const unsigned int                  d   (child.next & 0xf);
+        const std::array<unsigned int, 3>   u   (units(child.cell));
+
+        for (unsigned int k(0); k < 3; ++k)
+            child.used[u[k]] = parent.used[u[k]] | (1 << (d - 1));
+
+        child.c[child.cell] = static_cast<char>('0' + d);
+        child.next >>= 4;
+        return true;
+    }
+};
+
+///
+/// @brief Returns the i-th term of the Luby sequence: 1, 1, 2, 1, 1, 2, 4, 1,
+///  1, 2, 1, 1, 2, 4, 8, ...
+/// @details When the distribution of the run times is unknown, restarting
+///  after these multiples of a unit of time is within a logarithmic factor of
+///  the best restart strategy (Luby, Sinclair & Zuckerman, 1993).
+/// @param [in] i                   Index of the term, from 1.
+/// @returns Term of the sequence.
+///
+inline std::uintmax_t luby(std::uintmax_t i)
+{
+    assert(i != 0);
+
+    for (;;)
+    {
+        unsigned int k(1);
+
+        while ((std::uintmax_t(1) << k) - 1 < i)
+            ++k;
+
+        if ((std::uintmax_t(1) << k) - 1 == i)
+            return std::uintmax_t(1) << (k - 1);
+
+        i -= (std::uintmax_t(1) << (k - 1)) - 1;
+    }
+}
+
+///
+/// @brief Outcome of a run of `search_luby()`.
+///
+enum class run_outcome
+{
+    found,          ///< A solution was found.
+    exhausted,      ///< The subtree holds no solution.
+    cut             ///< The run ran out of nodes, or was stopped.
+};
+
+///
+/// @brief Performs recursive backtracking, trying the children of each node
+///  in random order, until a solution is found or the budget runs out.
+/// @tparam Problem                 Problem policy, see `backtrack()`.
+/// @tparam Sink                    Callable type, taking a solution.
+/// @tparam Prng                    Uniform random bit generator type.
+/// @param [in] prob                Problem to be solved.
+/// @param [in] n                   Node to be searched.
+/// @param [in] sink                Function to be called for the solution.
+/// @param [in,out] ctl             Control of the search, if any.
+/// @param [in,out] prng            Random generator.
+/// @param [in,out] budget          Number of nodes left to be checked.
+/// @param [in,out] nodes           Number of nodes checked.
+/// @param [in,out] children        Children of each level, reused.
+/// @param [in] level               Level of the node.
+/// @returns Outcome of the run.
+///
+template <typename Problem, typename Sink, typename Prng>
+run_outcome search_luby(const Problem &prob, const typename Problem::node &n,
+    Sink &sink, search_control *ctl, Prng &prng, std::uintmax_t &budget,
+    std::uintmax_t &nodes,
+    std::vector<std::vector<typename Problem::node>> &children,
+    std::size_t level)
+{
+    if (budget == 0 || (ctl != nullptr && ctl->stopped()))
+        return run_outcome::cut;
+
+    --budget;
+    ++nodes;
+
+    if (prob.reject(n))
+        return run_outcome::exhausted;
+
+    if (prob.accept(n))
+    {
+        if (ctl == nullptr || ctl->claim())
+            sink(prob.solution(n));
+
+        return run_outcome::found;
+    }
+
+    if (children.size() <= level)
+        children.resize(level + 1);
+
+    std::vector<typename Problem::node> &ch(children[level]);
+    typename Problem::node              child;
+
+    ch.clear();
+
+    if (prob.first_child(n, child))
+        do
+            ch.push_back(child);
+        while (prob.next_child(n, child));
+
+    std::shuffle(ch.begin(), ch.end(), prng);
+
+    //
+    // the deeper levels reuse `children`, so don't hold a reference into it
+    //
+    for (std::size_t i(0); i < children[level].size(); ++i)
+    {
+        const typename Problem::node c(children[level][i]);
+        const run_outcome r(search_luby(prob, c, sink, ctl, prng, budget,
+            nodes, children, level + 1));
+
+        if (r != run_outcome::exhausted)
+            return r;
+    }
+
+    return run_outcome::exhausted;
+}
+
+///
+/// @brief Finds a solution by randomized backtracking with restarts.
+/// @details Deterministic Depth-First Search may spend most of its time in a
+///  huge subtree without solutions, just because it was tried first; and it
+///  would do so on every run. Here the children of every node are tried in
+///  random order, and the search is restarted from the root, with other
+///  random choices, whenever its current run has checked more nodes than
+///  `unit` times the next term of the Luby sequence. So a run stuck in a
+///  barren subtree is soon abandoned, which makes the distribution of the
+///  time to the first solution much lighter tailed.
+///
+///  The search stays complete: the budgets grow without bound, so a run
+///  eventually either finds a solution or proves there is none.
+/// @note Unlike `backtrack()`, at most one solution is output, since the
+///  restarts would otherwise output some solutions several times.
+/// @tparam Problem                 Problem policy, see `backtrack()`.
+/// @tparam Sink                    Callable type, taking a solution.
+/// @param [in] prob                Problem to be solved.
+/// @param [in] root                Beginning node, to start with.
+/// @param [in] sink                Function to be called for the solution.
+/// @param [in] seed                Seed of the random generator; the same
+///                                 seed gives the same search.
+/// @param [in] unit                Number of nodes of the shortest runs; at
+///                                 its maximum the search never restarts.
+/// @param [in,out] ctl             Control of the search, if any; shared by
+///                                 searches with other seeds, the first one
+///                                 to find a solution can stop the others.
+/// @returns Number of nodes checked, over all runs.
+///
+template <typename Problem, typename Sink>
+std::uintmax_t backtrack_luby(const Problem &prob,
+    const typename Problem::node &root, Sink &&sink, std::uint64_t seed,
+    std::uintmax_t unit = 1 << 10, search_control *ctl = nullptr)
+try
+{
+    constexpr std::uintmax_t max(std::numeric_limits<std::uintmax_t>::max());
+
+    std::mt19937_64                                     prng        (seed);
+    std::vector<std::vector<typename Problem::node>>    children;
+    std::uintmax_t                                      nodes       (0);
+
+    for (std::uintmax_t i(1); ; ++i)
+    {
+        const std::uintmax_t    l       (luby(i));
+        std::uintmax_t          budget  (unit > max / l ? max : unit * l);
+
+        if (search_luby(prob, root, sink, ctl, prng, budget, nodes, children,
+            0) != run_outcome::cut || (ctl != nullptr && ctl->stopped()))
+        {
+            return nodes;
+        }
+    }
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Batch of solutions, handed over at once to a sink.
+/// @details The solutions are stored back to back, each followed by `'\n'`,
+///  which is also the format in which they are printed.
+///
+class solution_batch
+{
+public:
+
+    static constexpr std::size_t capacity = 64 << 10;
+
+    solution_batch()
+    {
+        buf.reserve(capacity);
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    bool full() const
+    {
+        return buf.size() >= capacity;
+    }
+
+    std::size_t size() const
+    {
+        return count;
+    }
+
+    std::string_view text() const
+    {
+        return buf;
+    }
+
+    void add(std::string_view sol)
+    {
+        buf += sol;
+        buf += '\n';
+        ++count;
+    }
+
+    void clear()
+    {
+        buf.clear();
+        count = 0;
+    }
+
+private:
+
+    std::string     buf;
+    std::size_t     count   = 0;
+};
+
+///
+/// @brief Writes a buffer to a file descriptor, retrying on partial writes
+///  and interruptions.
+/// @param [in] fd                  File descriptor.
+/// @param [in] p                   Buffer to be written.
+/// @param [in] n                   Size of the buffer, in bytes.
+/// @throws std::system_error       If writing fails.
+///
+void write_all(int fd, const char *p, std::size_t n)
+{
+    while (n != 0)
+    {
+        const ssize_t w(::write(fd, p, n));
+
+        if (w < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            throw std::system_error(errno, std::generic_category(), "write");
+        }
+
+        p += w;
+        n -= static_cast<std::size_t>(w);
+    }
+}
+
+///
+/// @brief Sink which writes solutions to a file descriptor, with `write(2)`,
+///  through a large buffer.
+///
+class write_sink
+{
+public:
+
+    ///
+    /// @brief Creates the sink.
+    /// @param [in] fd              File descriptor, not closed by the sink.
+    /// @param [in] buffer_size     Size of the buffer, in bytes.
+    ///
+    explicit write_sink(int fd = STDOUT_FILENO,
+        std::size_t buffer_size = 1 << 20):
+        fd(fd),
+        cap(buffer_size)
+    {
+        buf.reserve(cap);
+    }
+
+    write_sink(const write_sink &) = delete;
+    write_sink & operator = (const write_sink &) = delete;
+
+    ~write_sink()
+    {
+        try
+        {
+            flush();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void consume(const solution_batch &b)
+    {
+        if (buf.size() + b.text().size() > cap)
+            flush();
+
+        if (b.text().size() > cap)
+            write_all(fd, b.text().data(), b.text().size());
+        else
+            buf += b.text();
+    }
+
+    ///
+    /// @brief Writes the buffer out.
+    /// @throws std::system_error   If writing fails.
+    ///
+    void flush()
+    {
+        write_all(fd, buf.data(), buf.size());
+        buf.clear();
+    }
+
+private:
+
+    int             fd;
+    std::size_t     cap;
+    std::string     buf;
+};
+
+///
+/// @brief Sink which writes solutions to a file, through a memory-mapped
+///  window which slides along the file as it grows.
+///
+class mmap_sink
+{
+public:
+
+    ///
+    /// @brief Creates the sink, truncating the file.
+    /// @param [in] path            Path of the file.
+    /// @param [in] window_size     Size of the mapped window, in bytes; will
+    ///                             be rounded up to a multiple of the page.
+    /// @throws std::system_error   If the file cannot be opened or mapped.
+    ///
+    explicit mmap_sink(const std::string &path,
+        std::size_t window_size = 64 << 20):
+        fd(::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644))
+    {
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "open");
+
+        const std::size_t page(
+            static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)));
+
+        win = (window_size + page - 1) / page * page;
+
+        try
+        {
+            map();
+        }
+        catch (...)
+        {
+            ::close(fd);
+            throw;
+        }
+    }
+
+    mmap_sink(const mmap_sink &) = delete;
+    mmap_sink & operator = (const mmap_sink &) = delete;
+
+    ///
+    /// @brief Unmaps the window, and truncates the file to its contents.
+    ///
+    ~mmap_sink()
+    {
+        ::munmap(p, win);
+
+        if (::ftruncate(fd, static_cast<off_t>(base + pos)) != 0)
+            std::cerr << "cannot truncate the output file" << std::endl;
+
+        ::close(fd);
+    }
+
+    void consume(const solution_batch &b)
+    {
+        const char  *src    (b.text().data());
+        std::size_t n       (b.text().size());
+
+        while (n != 0)
+        {
+            if (pos == win)
+            {
+                ::munmap(p, win);
+                base += win;
+                pos = 0;
+                map();
+            }
+
+            const std::size_t k(std::min(n, win - pos));
+
+            std::memcpy(p + pos, src, k);
+            pos += k;
+            src += k;
+            n -= k;
+        }
+    }
+
+private:
+
+    ///
+    /// @brief Grows the file and maps the window at `base`.
+    ///
+    void map()
+    {
+        if (::ftruncate(fd, static_cast<off_t>(base + win)) != 0)
+            throw std::system_error(errno, std::generic_category(),
+                "ftruncate");
+
+        void *m(::mmap(nullptr, win, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+            static_cast<off_t>(base)));
+
+        if (m == MAP_FAILED)
+            throw std::system_error(errno, std::generic_category(), "mmap");
+
+        p = static_cast<char *>(m);
+    }
+
+    int             fd;
+    std::size_t     win     = 0;
+    char            *p      = nullptr;
+    std::uintmax_t  base    = 0;
+    std::size_t     pos     = 0;
+};
+
+///
+/// @brief Sink which only counts solutions.
+///
+struct counting_sink
+{
+    void consume(const solution_batch &b)
+    {
+        count += b.size();
+    }
+
+    std::uintmax_t count = 0;
+};
+
+///
+/// @brief Sink which calls a function for each solution.
+/// @tparam F                       Callable type, taking a `std::string_view`.
+///
+template <typename F>
+class callback_sink
+{
+public:
+
+    explicit callback_sink(F f):
+        f(std::move(f))
+    {
+    }
+
+    void consume(const solution_batch &b)
+    {
+        std::string_view t(b.text());
+
+        for (std::size_t i(t.find('\n')); i != t.npos; i = t.find('\n'))
+        {
+            f(t.substr(0, i));
+            t.remove_prefix(i + 1);
+        }
+    }
+
+private:
+
+    F f;
+};
+
+///
+/// @brief Runs a search, handing its solutions over to a sink in batches.
+/// @details The search is given a function to be called for each solution,
+///  which adds the solution to a `solution_batch` and, when the batch is full,
+///  passes it on to the sink with `sink.consume(batch)`.
+/// @tparam Sink                    Sink type, such as `write_sink`.
+/// @tparam Search                  Callable type, taking the function.
+/// @param [in,out] sink            Sink of the solutions.
+/// @param [in] search              Search to be run.
+/// @returns What the search returns.
+///
+template <typename Sink, typename Search>
+auto run_batched(Sink &sink, Search &&search)
+{
+    solution_batch b;
+
+    const auto emit =
+        [&sink, &b](std::string_view sol)
+        {
+            b.add(sol);
+
+            if (b.full())
+            {
+                sink.consume(b);
+                b.clear();
+            }
+        };
+
+    const auto r(search(emit));
+
+    if (!b.empty())
+        sink.consume(b);
+
+    return r;
+}
+
+///
+/// @brief Table of the solution suffixes of the last levels of the search, by
+///  constraint state.
+/// @details The subtree of a candidate only depends on its state and length,
+///  so for the candidates of length `base()`, the suffixes which complete them
+///  into solutions are listed once per state, in the order of the search.
+///  Rather than searching those subtrees, the frame-based search then appends
+///  each suffix of the candidate's state to the prefix, and emits it.
+/// @tparam Constraint              Constraint type, with `num_states` and
+///                                 `index()`.
+///
+template <typename Constraint>
+class suffix_table
+{
+public:
+
+    using state = typename Constraint::state;
+
+    ///
+    /// @brief Builds the table.
+    /// @param [in] con             Constraint to be satisfied.
+    /// @param [in] levels          Number of last levels to be tabulated.
+    ///
+    suffix_table(const Constraint &con, std::size_t levels):
+        len(con.max_length - std::min(levels, con.max_length)),
+        entries(con.num_states)
+    {
+        //
+        // find the states of the candidates of length `base()`; some of them
+        // may actually be rejected beforehand, which only wastes a little
+        //
+        std::vector<bool>   seen    (con.num_states, false);
+        std::vector<state>  cur     (1, con.initial());
+        std::vector<state>  nxt;
+
+        for (std::size_t l(0); l < len; ++l)
+        {
+            std::fill(seen.begin(), seen.end(), false);
+            nxt.clear();
+
+            for (const state &s: cur)
+                for (char ch: con.alphabet())
+                {
+                    const state t(con.step(s, ch));
+
+                    if (!seen[con.index(t)])
+                    {
+                        seen[con.index(t)] = true;
+                        nxt.push_back(t);
+                    }
+                }
+
+            cur.swap(nxt);
+        }
+
+        std::string suffix;
+
+        for (const state &s: cur)
+        {
+            entry &e(entries[con.index(s)]);
+
+            e.first = lens.size();
+            e.text = text.size();
+            build(con, s, len, suffix, e);
+            e.last = lens.size();
+            e.built = true;
+        }
+    }
+
+    ///
+    /// @brief Returns the length of the candidates that the table completes.
+    ///
+    std::size_t base() const
+    {
+        return len;
+    }
+
+    ///
+    /// @brief Returns if the table holds the suffixes of a state.
+    /// @param [in] con             Constraint to be satisfied.
+    /// @param [in] s               State of a candidate of length `base()`.
+    ///
+    bool covers(const Constraint &con, const state &s) const
+    {
+        return entries[con.index(s)].built;
+    }
+
+    ///
+    /// @brief Emits the solutions below a candidate of length `base()`.
+    /// @tparam Emit                Callable type, taking a solution.
+    /// @param [in] con             Constraint to be satisfied.
+    /// @param [in] s               State of the candidate, which the table
+    ///                             must cover.
+    /// @param [in,out] c           Candidate, restored on return.
+    /// @param [in] emit            Function to be called for each solution.
+    /// @param [in,out] ctl         Control of the search, if any.
+    /// @returns Number of nodes below the candidate; if the search was
+    ///  stopped, only those which the search would have checked up to the
+    ///  last solution emitted.
+    ///
+    template <typename Emit>
+    std::uintmax_t expand(const Constraint &con, const state &s,
+        std::string &c, Emit &emit, search_control *ctl) const
+    {
+        const entry &e(entries[con.index(s)]);
+        const char  *p(text.data() + e.text);
+
+        assert(e.built);
+
+        for (std::size_t i(e.first); i < e.last; ++i)
+        {
+            if (ctl != nullptr && (ctl->stopped() || !ctl->claim()))
+                return i == e.first ? 0 : upto[i - 1];
+
+            c.append(p, lens[i]);
+            emit(c);
+            c.resize(len);
+            p += lens[i];
+        }
+
+        return e.nodes;
+    }
+
+private:
+
+    struct entry
+    {
+        std::size_t     first   = 0;        ///< First suffix.
+        std::size_t     last    = 0;        ///< Past the last suffix.
+        std::size_t     text    = 0;        ///< Offset of the first suffix.
+        std::uintmax_t  nodes   = 0;        ///< Nodes below, checked.
+        bool            built   = false;    ///< Whether or not it is built.
+    };
+
+    void build(const Constraint &con, const state &s, std::size_t length,
+        std::string &suffix, entry &e)
+    {
+        for (char ch: con.alphabet())
+        {
+            const state t(con.step(s, ch));
+
+            ++e.nodes;
+
+            if (reject(con, t, length + 1))
+                continue;
+
+            suffix.push_back(ch);
+
+            if (con.accept(t, length + 1))
+            {
+                text += suffix;
+                lens.push_back(static_cast<unsigned char>(suffix.length()));
+                upto.push_back(e.nodes);
+            }
+
+            if (length + 1 < con.max_length)
+                build(con, t, length + 1, suffix, e);
+
+            suffix.pop_back();
+        }
+    }
+
+    std::size_t                 len;        ///< Length of the prefixes.
+    std::vector<entry>          entries;    ///< Suffixes, by state index.
+    std::vector<unsigned char>  lens;       ///< Length of each suffix.
+    std::vector<std::uintmax_t> upto;       ///< Nodes below, checked up to
+                                            ///< each suffix.
+    std::string                 text;       ///< Suffixes, back to back.
+};
+
+///
+/// @brief Poll function of `frm_hooks` which never stops the search.
+///
+struct no_poll
+{
+    bool operator () (const std::string &, const std::vector<std::uint64_t> &,
+        std::uintmax_t) const
+    {
+        return false;
+    }
+};
+
+///
+/// @brief Hooks of `search_frm()` to snapshot its frontier, and to resume
+///  from such a snapshot, see `backtrack_ckp()`.
+/// @details The frontier is the prefix buffer and the index of the next
+///  character to try at each level, from the beginning candidate down.
+/// @tparam Poll                    Callable type, taking the prefix, the
+///                                 frontier and the number of nodes checked
+///                                 so far, and returning whether or not the
+///                                 search must stop.
+///
+template <typename Poll>
+struct frm_hooks
+{
+    static constexpr std::uint32_t period = 1 << 16;    ///< Steps per poll.
+
+    const std::vector<std::uint64_t>    *resume;    ///< Frontier to resume
+                                                    ///< from, if any; read
+                                                    ///< on entry only.
+    Poll                                poll;       ///< Called every
+                                                    ///< `period` steps.
+};
+
+///
+/// @brief Performs non-recursive backtracking, using frames.
+/// @details A single prefix buffer is shared by all candidates, and each level
+///  of depth only stores the index of its next character to try, along with
+///  the constraint state of the prefix up to that level.
+///
+///  When resuming from a frontier, `c` must hold the whole prefix of the
+///  frontier, and `s` is still the state of the beginning candidate, i.e. of
+///  the first `c.length() + 1 - resume->size()` characters; the states of the
+///  other levels are recomputed from the prefix.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @tparam Emit                    Callable type, taking a solution.
+/// @tparam Poll                    Poll type of the hooks, see `frm_hooks`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in,out] c               Beginning candidate, restored on return.
+/// @param [in] s                   State of the beginning candidate.
+/// @param [in] emit                Function to be called for each solution.
+/// @param [in] limit               Length at which candidates are childless.
+/// @param [in,out] ctl             Control of the search, if any.
+/// @param [in,out] stats           Telemetry of the search, if any; the
+///                                 suffix table is then not used, since it
+///                                 has no per-length counts.
+/// @param [in] suffixes            Table of the last levels, if any; only
+///                                 used without a limit.
+/// @param [in,out] mem             Arena of the frames, if not the
+///                                 `thread_arena()`.
+/// @param [in,out] hooks           Snapshot and resume hooks, if any.
+/// @returns Number of nodes checked, rejected or not; when resuming, the
+///  beginning candidate isn't checked again, so isn't counted.
+///
+template <typename Constraint, typename Emit, typename Poll = no_poll>
+std::uintmax_t search_frm(const Constraint &con, std::string &c,
+    typename Constraint::state s, Emit &&emit,
+    std::size_t limit = std::numeric_limits<std::size_t>::max(),
+    search_control *ctl = nullptr, search_stats *stats = nullptr,
+    const suffix_table<Constraint> *suffixes = nullptr, arena *mem = nullptr,
+    frm_hooks<Poll> *hooks = nullptr)
+try
+{
+    using state = typename Constraint::state;
+
+    struct frame
+    {
+        std::size_t     next;       ///< Index of the next character to try.
+        state           s;          ///< State of the prefix at this level.
+    };
+
+    using frames = std::vector<frame, arena_allocator<frame>>;
+
+    const std::vector<std::uint64_t> *const from(
+        hooks != nullptr ? hooks->resume : nullptr);
+
+    const std::string           &alpha  (con.alphabet());
+    frames                      frm     (mem != nullptr ? *mem :
+        thread_arena());
+    std::uintmax_t              nodes   (from == nullptr ? 1 : 0);
+    const std::size_t           depth   (std::min(limit, con.max_length));
+    const std::size_t           root    (from == nullptr ? c.length() :
+        c.length() + 1 - from->size());
+    std::vector<std::uint64_t>  next;
+    std::uint32_t               tick    (0);
+
+    c.reserve(depth);
+    frm.reserve(depth + 1);
+
+    if (stats != nullptr)
+        stats->resize(con.max_length);
+
+    if (from != nullptr)
+    {
+        //
+        // rebuild the frames, recomputing the states from the prefix
+        //
+        assert(!from->empty() && from->size() <= c.length() + 1);
+
+        for (std::size_t i(0); i < from->size(); ++i)
+        {
+            assert((*from)[i] <= alpha.length());
+
+            if (i != 0)
+                s = con.step(s, c[root + i - 1]);
+
+            frm.push_back(frame{static_cast<std::size_t>((*from)[i]), s});
+        }
+    }
+    else
+    {
+        if (stats != nullptr)
+            ++stats->generated[c.length()];
+
+        if ((ctl != nullptr && ctl->stopped()) || reject(con, s, c.length()))
+        {
+            if (stats != nullptr)
+                ++stats->rejected[c.length()];
+
+            return nodes;
+        }
+
+        if (con.accept(s, c.length()) && (ctl == nullptr || ctl->claim()))
+        {
+            if (stats != nullptr)
+                ++stats->accepted[c.length()];
+
+            emit(c);
+        }
+
+        if (c.length() < depth)
+            frm.push_back(frame{0, s});
+    }
+
+    while (!frm.empty())
+    {
+        if (ctl != nullptr && ctl->stopped())
+        {
+            c.resize(root);
+            break;
+        }
+
+        if (hooks != nullptr && (++tick & (hooks->period - 1)) == 0)
+        {
+            next.clear();
+
+            for (const frame &f: frm)
+                next.push_back(f.next);
+
+            if (hooks->poll(c, next, nodes))
+            {
+                c.resize(root);
+                break;
+            }
+        }
+
+        //
+        // all the children of the current prefix were tried,
+        // so backtrack to the parent of the prefix
+        //
+        if (frm.back().next == alpha.length())
+        {
+            frm.pop_back();
+
+            if (!frm.empty())
+                c.pop_back();
+
+            continue;
+        }
+
+        //
+        // the descendants are tabulated: emit their solutions from the table
+        //
+        if (suffixes != nullptr && frm.back().next == 0 &&
+            c.length() == suffixes->base() && depth == con.max_length &&
+            stats == nullptr && suffixes->covers(con, frm.back().s))
+        {
+            frm.back().next = alpha.length();
+            nodes += suffixes->expand(con, frm.back().s, c, emit, ctl);
+            continue;
+        }
+
+        //
+        // the children are leaves: check them all at once, if the constraint
+        // can, and only step into the solutions
+        //
+        if constexpr (has_siblings<Constraint>::value)
+            if (frm.back().next == 0 && c.length() + 1 == depth &&
+                alpha.length() <= 64)
+            {
+                const sibling_masks m   (con.siblings(frm.back().s,
+                    c.length()));
+                std::uint64_t       acc (m.accepted & ~m.rejected);
+
+                frm.back().next = alpha.length();
+                nodes += alpha.length();
+
+                if (stats != nullptr)
+                {
+                    stats->generated[depth] += alpha.length();
+                    stats->rejected[depth] += bit_count(m.rejected);
+                    stats->accepted[depth] += bit_count(acc);
+                }
+
+                for (; acc != 0; acc &= acc - 1)
+                {
+                    if (ctl != nullptr && (ctl->stopped() || !ctl->claim()))
+                        break;
+
+                    c.push_back(alpha[lowest_bit(acc)]);
+                    emit(c);
+                    c.pop_back();
+                }
+
+                continue;
+            }
+
+        const char ch(alpha[frm.back().next++]);
+
+        s = con.step(frm.back().s, ch);
+        c.push_back(ch);
+        ++nodes;
+
+        if (stats != nullptr)
+            ++stats->generated[c.length()];
+
+        if (reject(con, s, c.length()))
+        {
+            if (stats != nullptr)
+                ++stats->rejected[c.length()];
+
+            c.pop_back();
+            continue;
+        }
+
+        if (con.accept(s, c.length()) && (ctl == nullptr || ctl->claim()))
+        {
+            if (stats != nullptr)
+                ++stats->accepted[c.length()];
+
+            emit(c);
+        }
+
+        if (c.length() < depth)
+        {
+            frm.push_back(frame{0, s});
+
+            if (stats != nullptr)
+                stats->frontier(frm.size());
+        }
+        else
+            c.pop_back();
+    }
+
+    return nodes;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Performs non-recursive backtracking, using frames.
+/// @see `search_frm()`
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] start               Beginning candidate, to start with.
+/// @returns Number of nodes checked, rejected or not.
+///
+template <typename Constraint>
+std::uintmax_t backtrack_frm(const Constraint &con, const std::string &start)
+try
+{
+    std::string c(start);
+
+    return search_frm(con, c, state_of(con, c),
+        [](const std::string &sol)
+        {
+            std::cout << sol << '\n';
+        });
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Performs non-recursive backtracking, using frames, handing the
+///  solutions over to a sink in batches.
+/// @see `search_frm()`, `run_batched()`
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @tparam Sink                    Sink type, such as `write_sink`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] start               Beginning candidate, to start with.
+/// @param [in,out] sink            Sink of the solutions.
+/// @param [in,out] ctl             Control of the search, if any.
+/// @param [in,out] stats           Telemetry of the search, if any.
+/// @returns Number of nodes checked, rejected or not.
+///
+template <typename Constraint, typename Sink>
+std::uintmax_t backtrack_frm(const Constraint &con, const std::string &start,
+    Sink &sink, search_control *ctl = nullptr, search_stats *stats = nullptr)
+try
+{
+    std::string c(start);
+
+    return run_batched(sink,
+        [&](const auto &emit)
+        {
+            return search_frm(con, c, state_of(con, c), emit,
+                con.max_length, ctl, stats);
+        });
+}
+catch (const std::system_error &e)
+{
+    std::cerr << "`std::system_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Performs non-recursive backtracking, using frames, finishing the
+///  last levels from a table of suffixes.
+/// @see `search_frm()`, `suffix_table`
+/// @tparam Constraint              Constraint type, with `num_states` and
+///                                 `index()`.
+/// @tparam Sink                    Sink type, such as `write_sink`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] start               Beginning candidate, to start with.
+/// @param [in,out] sink            Sink of the solutions.
+/// @param [in] levels              Number of last levels to be tabulated.
+/// @param [in,out] ctl             Control of the search, if any.
+/// @returns Number of nodes checked, rejected or not.
+///
+template <typename Constraint, typename Sink>
+std::uintmax_t backtrack_sfx(const Constraint &con, const std::string &start,
+    Sink &sink, std::size_t levels = 2, search_control *ctl = nullptr)
+try
+{
+    const suffix_table<Constraint>  tbl (con, levels);
+    std::string                     c   (start);
+
+    return run_batched(sink,
+        [&](const auto &emit)
+        {
+            return search_frm(con, c, state_of(con, c), emit,
+                con.max_length, ctl, nullptr, &tbl);
+        });
+}
+catch (const std::system_error &e)
+{
+    std::cerr << "`std::system_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Set by the `SIGTERM` handler installed by `backtrack_ckp()`.
+///
+volatile std::sig_atomic_t sigterm_received(0);
+
+extern "C" void on_sigterm(int)
+{
+    sigterm_received = 1;
+}
+
+///
+/// @brief Installs the `SIGTERM` handler, and restores the previous one on
+///  destruction.
+///
+class sigterm_guard
+{
+public:
+
+    ///
+    /// @brief Installs the handler.
+    /// @throws std::system_error   If the handler cannot be installed.
+    ///
+    sigterm_guard()
+    {
+        struct sigaction sa;
+
+        std::memset(&sa, 0, sizeof sa);
+        sa.sa_handler = on_sigterm;
+        ::sigemptyset(&sa.sa_mask);
+
+        if (::sigaction(SIGTERM, &sa, &old) != 0)
+            throw std::system_error(errno, std::generic_category(),
+                "sigaction");
+    }
+
+    sigterm_guard(const sigterm_guard &) = delete;
+    sigterm_guard & operator = (const sigterm_guard &) = delete;
+
+    ~sigterm_guard()
+    {
+        ::sigaction(SIGTERM, &old, nullptr);
+    }
+
+private:
+
+    struct sigaction old;
+};
+
+///
+/// @brief Snapshot of a frame-based search, from which it can be resumed.
+/// @details The constraint states are not saved, since they are recomputed
+///  from the prefix on loading, so any constraint can be checkpointed. The
+///  file is in the native byte order, so it is only meant to be loaded on the
+///  machine which saved it.
+///
+struct frm_checkpoint
+{
+    std::uint64_t               root    = 0;    ///< Length of the start.
+    std::string                 prefix;         ///< Shared prefix buffer.
+    std::vector<std::uint64_t>  next;           ///< Next index, per level.
+    std::uint64_t               output  = 0;    ///< Bytes of output written.
+    std::uint64_t               nodes   = 0;    ///< Nodes checked so far.
+
+    ///
+    /// @brief Saves the snapshot, atomically: it is written to a temporary
+    ///  file which is synced then renamed over `path`.
+    /// @param [in] path            Path of the checkpoint file.
+    /// @throws std::system_error   If the file cannot be written.
+    ///
+    void save(const std::string &path) const
+    {
+        std::string buf(magic, sizeof magic);
+
+        const auto put =
+            [&buf](std::uint64_t v)
+            {
+                buf.append(reinterpret_cast<const char *>(&v), sizeof v);
+            };
+
+        put(root);
+        put(prefix.length());
+        buf += prefix;
+        put(output);
+        put(nodes);
+        put(next.size());
+
+        for (const std::uint64_t n: next)
+            put(n);
+
+        const std::string   tmp (path + ".tmp");
+        const int           fd  (::open(tmp.c_str(),
+            O_WRONLY | O_CREAT | O_TRUNC, 0644));
+
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "open");
+
+        try
+        {
+            write_all(fd, buf.data(), buf.size());
+
+            if (::fsync(fd) != 0)
+                throw std::system_error(errno, std::generic_category(),
+                    "fsync");
+        }
+        catch (...)
+        {
+            ::close(fd);
+            throw;
+        }
+
+        ::close(fd);
+
+        if (std::rename(tmp.c_str(), path.c_str()) != 0)
+            throw std::system_error(errno, std::generic_category(), "rename");
+    }
+
+    ///
+    /// @brief Loads a snapshot.
+    /// @param [in] path            Path of the checkpoint file.
+    /// @returns Whether or not there was a checkpoint file.
+    /// @throws std::system_error   If the file cannot be read.
+    /// @throws std::runtime_error  If the file is not a valid checkpoint.
+    ///
+    bool load(const std::string &path)
+    {
+        const int fd(::open(path.c_str(), O_RDONLY));
+
+        if (fd < 0)
+        {
+            if (errno == ENOENT)
+                return false;
+
+            throw std::system_error(errno, std::generic_category(), "open");
+        }
+
+        std::string buf;
+        char        blk[4096];
+
+        for (;;)
+        {
+            const ssize_t r(::read(fd, blk, sizeof blk));
+
+            if (r < 0 && errno == EINTR)
+                continue;
+
+            if (r < 0)
+            {
+                const int e(errno);
+
+                ::close(fd);
+                throw std::system_error(e, std::generic_category(), "read");
+            }
+
+            if (r == 0)
+                break;
+
+            buf.append(blk, static_cast<std::size_t>(r));
+        }
+
+        ::close(fd);
+
+        std::string_view in(buf);
+
+        const auto get =
+            [&in]()
+            {
+                std::uint64_t v;
+
+                if (in.size() < sizeof v)
+                    throw std::runtime_error("truncated checkpoint");
+
+                std::memcpy(&v, in.data(), sizeof v);
+                in.remove_prefix(sizeof v);
+                return v;
+            };
+
+        if (in.substr(0, sizeof magic) != std::string_view(magic, sizeof magic))
+            throw std::runtime_error("not a checkpoint");
+
+        in.remove_prefix(sizeof magic);
+        root = get();
+
+        const std::uint64_t len(get());
+
+        if (in.size() < len || len < root)
+            throw std::runtime_error("truncated checkpoint");
+
+        prefix.assign(in.data(), len);
+        in.remove_prefix(len);
+        output = get();
+        nodes = get();
+        next.resize(get());
+
+        for (std::uint64_t &n: next)
+            n = get();
+
+        if (next.size() != len - root + 1)
+            throw std::runtime_error("inconsistent checkpoint");
+
+        return true;
+    }
+
+    static constexpr char magic[8] = {'B', 'T', 'C', 'K', 'P', 'T', '0', '1'};
+};
+
+///
+/// @brief Performs non-recursive backtracking, using frames, saving its
+///  frontier to a checkpoint file periodically and on `SIGTERM`.
+/// @details The frontier of the frame-based search is only the prefix buffer
+///  and the index of the next character to try at each level, so it is small
+///  enough to be saved often. Before each snapshot the solutions are flushed
+///  and synced to the output file, and the snapshot records the size of the
+///  output; on resuming, the output is truncated back to that size, so the
+///  solutions found after the snapshot are neither lost nor duplicated.
+///
+///  The search itself is `search_frm()`, whose hooks are polled every
+///  `frm_hooks::period` steps, to take the snapshots and to resume from them.
+///
+///  When the search completes, the checkpoint file is removed. On `SIGTERM`
+///  a snapshot is saved and the function returns early, leaving
+///  `sigterm_received` set until the next call; calling it again with the
+///  same arguments resumes the search.
+/// @note The limit and telemetry of `search_frm()` are not supported, since
+///  they wouldn't survive a restart anyway.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] start               Beginning candidate, to start with.
+/// @param [in] out_path            Path of the output file.
+/// @param [in] ckp_path            Path of the checkpoint file.
+/// @param [in] period              Time between two snapshots.
+/// @returns Number of nodes checked, rejected or not, over all the runs.
+/// @throws std::system_error       If a file cannot be read or written.
+/// @throws std::runtime_error      If the checkpoint is invalid, or was made
+///                                 from another start.
+///
+template <typename Constraint>
+std::uintmax_t backtrack_ckp(const Constraint &con, const std::string &start,
+    const std::string &out_path, const std::string &ckp_path,
+    std::chrono::steady_clock::duration period = std::chrono::seconds(60))
+try
+{
+    using clock = std::chrono::steady_clock;
+
+    const std::string   &alpha  (con.alphabet());
+    std::string         c       (start);
+    frm_checkpoint      ckp;
+    const bool          resume  (ckp.load(ckp_path));
+    std::uintmax_t      nodes   (0);
+    bool                done    (true);
+    const std::size_t   root    (start.length());
+
+    if (resume && (ckp.root != root || ckp.prefix.length() >= con.max_length ||
+        ckp.prefix.compare(0, root, start) != 0))
+    {
+        throw std::runtime_error("checkpoint made from another start");
+    }
+
+    if (resume)
+        for (const std::uint64_t n: ckp.next)
+            if (n > alpha.length())
+                throw std::runtime_error("inconsistent checkpoint");
+
+    const int fd(::open(out_path.c_str(), O_WRONLY | O_CREAT, 0644));
+
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "open");
+
+    try
+    {
+        //
+        // drop the solutions found after the snapshot, they will be found
+        // again
+        //
+        const off_t out_size(resume ? static_cast<off_t>(ckp.output) : 0);
+
+        if (::ftruncate(fd, out_size) != 0 ||
+            ::lseek(fd, out_size, SEEK_SET) < 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                "truncate");
+        }
+
+        // a signal of a previous call was already handled
+        sigterm_received = 0;
+
+        const sigterm_guard sig;
+        write_sink          ws      (fd);
+        solution_batch      b;
+        std::uint64_t       written (static_cast<std::uint64_t>(out_size));
+        const std::uint64_t before  (resume ? ckp.nodes : 0);
+        clock::time_point   due     (clock::now() + period);
+
+        const auto emit =
+            [&](const std::string &sol)
+            {
+                b.add(sol);
+
+                if (b.full())
+                {
+                    written += b.text().size();
+                    ws.consume(b);
+                    b.clear();
+                }
+            };
+
+        const auto snapshot =
+            [&](const std::string &prefix,
+                const std::vector<std::uint64_t> &next, std::uintmax_t n)
+            {
+                written += b.text().size();
+                ws.consume(b);
+                b.clear();
+                ws.flush();
+
+                if (::fdatasync(fd) != 0)
+                    throw std::system_error(errno, std::generic_category(),
+                        "fdatasync");
+
+                ckp.root = root;
+                ckp.prefix = prefix;
+                ckp.output = written;
+                ckp.nodes = before + n;
+                ckp.next = next;
+                ckp.save(ckp_path);
+            };
+
+        const auto poll =
+            [&](const std::string &prefix,
+                const std::vector<std::uint64_t> &next, std::uintmax_t n)
+            {
+                if (sigterm_received != 0)
+                    done = false;
+
+                if (!done || clock::now() >= due)
+                {
+                    snapshot(prefix, next, n);
+                    due = clock::now() + period;
+                }
+
+                return !done;
+            };
+
+        //
+        // the frontier is read on entry, before the first snapshot
+        // overwrites `ckp`
+        //
+        frm_hooks<decltype(poll)> hooks{resume ? &ckp.next : nullptr, poll};
+
+        if (resume)
+            c = ckp.prefix;
+
+        nodes = before + search_frm<Constraint>(con, c,
+            state_of(con, start), emit, con.max_length, nullptr, nullptr,
+            nullptr, nullptr, &hooks);
+
+        if (done)
+        {
+            if (!b.empty())
+                ws.consume(b);
+
+            ws.flush();
+        }
+    }
+    catch (...)
+    {
+        ::close(fd);
+        throw;
+    }
+
+    ::close(fd);
+
+    if (done && ::unlink(ckp_path.c_str()) != 0 && errno != ENOENT)
+        throw std::system_error(errno, std::generic_category(), "unlink");
+
+    return nodes;
+}
+catch (const std::system_error &e)
+{
+    std::cerr << "`std::system_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (const std::runtime_error &e)
+{
+    std::cerr << "`std::runtime_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Performs iterative deepening backtracking.
+/// @details The frame-based search is run repeatedly, with the candidates'
+///  length limited to 0, 1, 2, ... more characters than `start`, and each run
+///  only prints the solutions of the limit length. So the solutions are found
+///  in the same order as in a Breadth-First Search, grouped by length, yet the
+///  memory use is that of a Depth-First Search, i.e. O(depth).
+///
+///  The price to pay is that every run checks again the nodes of all previous
+///  runs. As the tree gets wider with depth, this overhead is small, and it's
+///  printed to `std::cerr` at the end.
+///
+///  Solutions shorter than the limit are found again by every run, so they
+///  don't count toward the control's limit: each run has a control of its
+///  own, cancelled when a solution of the limit length finds `ctl` stopped.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] start               Beginning candidate, to start with.
+/// @param [in,out] ctl             Control of the search, if any; note that
+///  it's only checked between runs and at solutions of the limit length.
+/// @returns Number of nodes checked, rejected or not, over all runs.
+///
+template <typename Constraint>
+std::uintmax_t backtrack_ids(const Constraint &con, const std::string &start,
+    search_control *ctl = nullptr)
+try
+{
+    const typename Constraint::state s(state_of(con, start));
+
+    std::string     c       (start);
+    std::uintmax_t  nodes   (0);
+    std::uintmax_t  last    (0);
+
+    for (std::size_t limit(start.length()); limit <= con.max_length &&
+        (ctl == nullptr || !ctl->stopped()); ++limit)
+    {
+        search_control run;
+
+        last = search_frm(con, c, s,
+            [&](const std::string &sol)
+            {
+                if (sol.length() != limit)
+                    return;
+
+                if (ctl == nullptr || (!ctl->stopped() && ctl->claim()))
+                    std::cout << sol << '\n';
+
+                if (ctl != nullptr && ctl->stopped())
+                    run.cancel();
+            },
+            limit, &run);
+
+        nodes += last;
+    }
+
+    //
+    // the last run alone checked all the nodes, which is what a single
+    // Breadth-First Search would have done
+    //
+
+    std::cerr << '`' << __func__ << "` checked " << nodes << " nodes, ";
+    std::cerr << nodes - last << " more than a single search (";
+    std::cerr << 100.0 * (nodes - last) / last << "%)" << std::endl;
+
+    return nodes;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Performs parallel non-recursive backtracking, using work stealing.
+/// @details The search tree is split by prefix into tasks. Every worker thread
+///  owns a deque of tasks: it takes tasks from the back of its own deque and,
+///  when that is empty, steals tasks from the front of the other deques, which
+///  hold the shallowest tasks, thus the largest subtrees.
+///
+///  A task whose subtree is at most `grain` levels deep is searched with
+///  `search_frm()`, otherwise the task's candidate is checked and its children
+///  are pushed as new tasks.
+///
+///  Solutions are collected in per-thread buffers. If `ordered` is `false` the
+///  buffers are printed as soon as they grow large, in no particular order.
+///  If `ordered` is `true` every task keeps its own buffer, and the buffers are
+///  printed at the end in the same order as the sequential search would.
+///
+///  A worker which finds no task to take yields a few times, then sleeps on a
+///  condition variable, for longer and longer naps; it is woken up as soon as
+///  new tasks are pushed, or when the search is over. The count of tasks not
+///  done yet is updated once per task, for its children and itself at once.
+///
+///  Each worker allocates its deque of tasks from an `arena` guarded by its
+///  lock, and its task buffers from an `arena` of its own, so that stealing
+///  and collecting solutions don't contend on the system allocator.
+/// @warning In ordered mode all solutions are held in memory until the end!
+/// @note With GCC and Clang, the program must be compiled with `-pthread`.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] start               Beginning candidate, to start with.
+/// @param [in] ordered             Whether or not to print in sequential order.
+/// @param [in] num_threads         Number of worker threads, `0` for automatic.
+/// @param [in] grain               Depth of the subtrees searched sequentially.
+/// @param [in,out] ctl             Control of the search, if any; note that
+///                                 with a limit, the solutions output aren't
+///                                 necessarily the first ones in sequential
+///                                 order, even in ordered mode.
+/// @param [in,out] stats           Telemetry of the search, if any; the
+///                                 frontier peak is the largest deque of
+///                                 tasks or stack of frames of any thread.
+/// @returns Number of nodes checked, rejected or not.
+///
+template <typename Constraint>
+std::uintmax_t backtrack_par(const Constraint &con, const std::string &start,
+    bool ordered = false, unsigned int num_threads = 0, std::size_t grain = 3,
+    search_control *ctl = nullptr, search_stats *stats = nullptr)
+try
+{
+    using state = typename Constraint::state;
+
+    ///
+    /// @brief Subtree to be searched.
+    ///
+    struct task
+    {
+        std::string     c;
+        state           s;
+    };
+
+    ///
+    /// @brief Solutions found by a task, in ordered mode; comparing the
+    ///  candidates of the tasks by `rank` gives the sequential order.
+    ///
+    struct chunk
+    {
+        std::string     c;
+        arena_string    text;
+    };
+
+    ///
+    /// @brief Per-thread data, aligned so that workers don't share cache lines.
+    ///
+    struct alignas(64) worker
+    {
+        std::mutex                              mtx;
+        arena                                   shared;
+        arena                                   own;
+        std::deque<task, arena_allocator<task>> tasks   {shared};
+        arena_string                            out     {own};
+        std::vector<chunk>                      chunks;
+        std::uintmax_t                          nodes   = 0;
+        search_stats                            stats;
+    };
+
+    constexpr std::size_t   flush_size  (1 << 20);
+    constexpr unsigned int  max_spins   (16);
+
+    constexpr std::chrono::microseconds min_nap(50), max_nap(1000);
+
+    const std::string                       &alpha  (con.alphabet());
+    std::array<std::size_t, UCHAR_MAX + 1>  rank    {};
+
+    for (std::size_t i(0); i < alpha.length(); ++i)
+        rank[static_cast<unsigned char>(alpha[i])] = i;
+
+    if (num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<worker>         wrk     (num_threads);
+    std::atomic<std::size_t>    pending (1);
+    std::atomic<bool>           failed  (false);
+    std::exception_ptr          eptr;
+    std::mutex                  out_mtx;
+    std::mutex                  idle_mtx;
+    std::condition_variable     idle_cv;
+    std::atomic<unsigned int>   sleepers(0);
+
+    wrk.front().tasks.push_back(task{start, state_of(con, start)});
+
+    const auto flush =
+        [&out_mtx](arena_string &out)
+        {
+            const std::lock_guard<std::mutex> lck(out_mtx);
+
+            std::cout.write(out.data(), out.size());
+            out.clear();
+        };
+
+    const auto pop =
+        [&wrk](std::size_t self, task &t) -> bool
+        {
+            for (std::size_t i(0); i < wrk.size(); ++i)
+            {
+                worker &w(wrk[(self + i) % wrk.size()]);
+
+                const std::lock_guard<std::mutex> lck(w.mtx);
+
+                if (w.tasks.empty())
+                    continue;
+
+                if (i == 0)
+                {
+                    t = std::move(w.tasks.back());
+                    w.tasks.pop_back();
+                }
+                else
+                {
+                    t = std::move(w.tasks.front());
+                    w.tasks.pop_front();
+                }
+
+                return true;
+            }
+
+            return false;
+        };
+
+    const auto process =
+        [&](worker &w, task &t)
+        {
+            bool pushed(false);
+
+            arena_string &out(ordered ? w.chunks.emplace_back(
+                chunk{t.c, arena_string(w.own)}).text : w.out);
+
+            const auto emit =
+                [&out](const std::string &sol)
+                {
+                    out += sol;
+                    out += '\n';
+                };
+
+            if (con.max_length - std::min(con.max_length, t.c.length()) <=
+                grain)
+            {
+                w.nodes += search_frm(con, t.c, t.s, emit, con.max_length,
+                    ctl, stats != nullptr ? &w.stats : nullptr);
+            }
+            else
+            {
+                ++w.nodes;
+
+                if (stats != nullptr)
+                {
+                    w.stats.resize(con.max_length);
+                    ++w.stats.generated[t.c.length()];
+                }
+
+                if (reject(con, t.s, t.c.length()))
+                {
+                    if (stats != nullptr)
+                        ++w.stats.rejected[t.c.length()];
+                }
+                else
+                {
+                    if (con.accept(t.s, t.c.length()) &&
+                        (ctl == nullptr || ctl->claim()))
+                    {
+                        if (stats != nullptr)
+                            ++w.stats.accepted[t.c.length()];
+
+                        emit(t.c);
+                    }
+
+                    //
+                    // the children are counted before anyone can take them,
+                    // and the task itself is done: one update for both
+                    //
+                    pending += alpha.length() - 1;
+
+                    {
+                        const std::lock_guard<std::mutex> lck(w.mtx);
+
+                        for (std::size_t i(alpha.length()); i-- != 0;)
+                            w.tasks.push_back(task{t.c + alpha[i],
+                                con.step(t.s, alpha[i])});
+
+                        if (stats != nullptr)
+                            w.stats.frontier(w.tasks.size());
+                    }
+
+                    if (sleepers.load() != 0)
+                        idle_cv.notify_all();
+
+                    pushed = true;
+                }
+            }
+
+            if (ordered && out.empty())
+                w.chunks.pop_back();
+            else
+            if (!ordered && out.size() >= flush_size)
+                flush(out);
+
+            if (!pushed && --pending == 0)
+                idle_cv.notify_all();
+        };
+
+    const auto run =
+        [&](std::size_t self)
+        {
+            try
+            {
+                task                        t;
+                unsigned int                spins   (0);
+                std::chrono::microseconds   nap     (min_nap);
+
+                while (pending.load() != 0 && !failed.load() &&
+                    (ctl == nullptr || !ctl->stopped()))
+                {
+                    if (pop(self, t))
+                    {
+                        spins = 0;
+                        nap = min_nap;
+                        process(wrk[self], t);
+                        continue;
+                    }
+
+                    if (++spins <= max_spins)
+                    {
+                        std::this_thread::yield();
+                        continue;
+                    }
+
+                    //
+                    // the nap is bounded, so a wake-up which is missed
+                    // between the last `pop()` and the wait costs little
+                    //
+                    std::unique_lock<std::mutex> lck(idle_mtx);
+
+                    ++sleepers;
+                    idle_cv.wait_for(lck, nap);
+                    --sleepers;
+                    nap = std::min(nap * 2, max_nap);
+                }
+            }
+            catch (...)
+            {
+                {
+                    const std::lock_guard<std::mutex> lck(out_mtx);
+
+                    if (!failed.exchange(true))
+                        eptr = std::current_exception();
+                }
+
+                idle_cv.notify_all();
+            }
+        };
+
+    std::vector<std::thread> thr;
+
+    for (std::size_t i(1); i < num_threads; ++i)
+        thr.emplace_back(run, i);
+
+    run(0);
+
+    for (std::thread &th: thr)
+        th.join();
+
+    if (failed.load())
+        std::rethrow_exception(eptr);
+
+    std::uintmax_t nodes(0);
+
+    if (ordered)
+    {
+        std::vector<chunk> chunks;
+
+        for (worker &w: wrk)
+            std::move(w.chunks.begin(), w.chunks.end(),
+                std::back_inserter(chunks));
+
+        std::sort(chunks.begin(), chunks.end(),
+            [&rank](const chunk &lhs, const chunk &rhs) -> bool
+            {
+                return std::lexicographical_compare(lhs.c.begin(),
+                    lhs.c.end(), rhs.c.begin(), rhs.c.end(),
+                    [&rank](char a, char b) -> bool
+                    {
+                        return rank[static_cast<unsigned char>(a)] <
+                            rank[static_cast<unsigned char>(b)];
+                    });
+            });
+
+        for (const chunk &ch: chunks)
+            std::cout.write(ch.text.data(), ch.text.size());
+    }
+
+    for (worker &w: wrk)
+    {
+        flush(w.out);
+        nodes += w.nodes;
+
+        if (stats != nullptr)
+            stats->merge(w.stats);
+    }
+
+    return nodes;
+}
+catch (const std::system_error &e)
+{
+    std::cerr << "`std::system_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Queue of fixed-width records which spills to a temporary file.
+/// @details Records are appended to a memory buffer. When the buffer would
+///  grow beyond its budget, it's written to a temporary file, sequentially, and
+///  emptied. Records are read back in the order they were pushed, also with
+///  sequential reads, so memory use is capped while I/O runs at disk bandwidth.
+///
+class spill_queue
+{
+public:
+
+    ///
+    /// @brief Creates an empty queue.
+    /// @param [in] record_size     Size of a record, in bytes.
+    /// @param [in] budget          Maximum memory used for records, in bytes.
+    ///
+    spill_queue(std::size_t record_size, std::size_t budget):
+        rsize(record_size),
+        cap(std::max(record_size, budget / record_size * record_size))
+    {
+        buf.reserve(cap);
+    }
+
+    spill_queue(const spill_queue &) = delete;
+    spill_queue & operator = (const spill_queue &) = delete;
+
+    ~spill_queue()
+    {
+        if (file != nullptr)
+            std::fclose(file);
+    }
+
+    ///
+    /// @brief Returns the number of records pushed.
+    ///
+    std::uintmax_t size() const
+    {
+        return count;
+    }
+
+    ///
+    /// @brief Returns the number of bytes spilled to the temporary file.
+    ///
+    std::uintmax_t spilled() const
+    {
+        return written;
+    }
+
+    ///
+    /// @brief Appends a record.
+    /// @param [in] rec             Record of `record_size` bytes.
+    ///
+    void push(const char *rec)
+    {
+        if (buf.size() + rsize > cap)
+            spill();
+
+        buf.insert(buf.end(), rec, rec + rsize);
+        ++count;
+    }
+
+    ///
+    /// @brief Calls a function for every record, in order, then empties the
+    ///  queue.
+    /// @tparam F               Callable type, taking a `const char *` record.
+    /// @param [in] f           Function to be called for every record.
+    ///
+    template <typename F>
+    void drain(F &&f)
+    {
+        if (file != nullptr)
+        {
+            spill();
+            std::rewind(file);
+
+            while (written != 0)
+            {
+                buf.resize(std::min<std::uintmax_t>(cap, written));
+
+                if (std::fread(buf.data(), 1, buf.size(), file) != buf.size())
+                    throw std::runtime_error("cannot read temporary file");
+
+                written -= buf.size();
+
+                for (std::size_t i(0); i < buf.size(); i += rsize)
+                    f(buf.data() + i);
+            }
+
+            std::fclose(file);
+            file = nullptr;
+        }
+        else
+        {
+            for (std::size_t i(0); i < buf.size(); i += rsize)
+                f(buf.data() + i);
+        }
+
+        buf.clear();
+        count = 0;
+    }
+
+private:
+
+    ///
+    /// @brief Writes the memory buffer to the temporary file, and empties it.
+    ///
+    void spill()
+    {
+        if (file == nullptr && (file = std::tmpfile()) == nullptr)
+            throw std::runtime_error("cannot create temporary file");
+
+        if (std::fwrite(buf.data(), 1, buf.size(), file) != buf.size())
+            throw std::runtime_error("cannot write temporary file");
+
+        written += buf.size();
+        buf.clear();
+    }
+
+    std::size_t         rsize;
+    std::size_t         cap;
+    std::vector<char>   buf;
+    std::FILE           *file       = nullptr;
+    std::uintmax_t      written     = 0;
+    std::uintmax_t      count       = 0;
+};
+
+///
+/// @brief Performs memory-bounded non-recursive backtracking, level by level
+///  (Breadth-First Search).
+/// @details Unlike `backtrack_que()`, the candidates of each level are stored as
+///  fixed-width records (constraint state, then characters) in a `spill_queue`,
+///  which spills to a temporary file when the memory budget is exceeded. Only
+///  two levels are held at any time, the one being read and the next one.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] start               Beginning candidate, to start with.
+/// @param [in] budget              Maximum memory used for candidates, in bytes.
+/// @param [in,out] ctl             Control of the search, if any.
+/// @returns Number of nodes checked, rejected or not.
+///
+template <typename Constraint>
+std::uintmax_t backtrack_bfs(const Constraint &con, const std::string &start,
+    std::size_t budget = 64 << 20, search_control *ctl = nullptr)
+try
+{
+    using state = typename Constraint::state;
+
+    static_assert(std::is_trivially_copyable<state>::value,
+        "the constraint state must be trivially copyable");
+
+    const std::string   &alpha  (con.alphabet());
+    const state         s0      (state_of(con, start));
+    std::uintmax_t      nodes   (1);
+    std::uintmax_t      spilled (0);
+
+    if ((ctl != nullptr && ctl->stopped()) ||
+        reject(con, s0, start.length()))
+        return nodes;
+
+    if (con.accept(s0, start.length()) && (ctl == nullptr || ctl->claim()))
+        std::cout << start << '\n';
+
+    if (start.length() >= con.max_length)
+        return nodes;
+
+    auto cur(std::make_unique<spill_queue>(
+        sizeof (state) + start.length(), budget / 2));
+
+    {
+        std::vector<char> rec(sizeof (state) + start.length());
+
+        std::memcpy(rec.data(), &s0, sizeof (state));
+        std::copy(start.begin(), start.end(), rec.begin() + sizeof (state));
+        cur->push(rec.data());
+    }
+
+    for (std::size_t len(start.length() + 1); cur->size() != 0 &&
+        (ctl == nullptr || !ctl->stopped()); ++len)
+    {
+        const std::size_t   rsize   (sizeof (state) + len);
+        auto                nxt     (std::make_unique<spill_queue>(
+            rsize, budget / 2));
+        std::vector<char>   rec     (rsize);
+        std::string         c       (len, '\0');
+
+        cur->drain(
+            [&](const char *parent)
+            {
+                state s;
+
+                std::memcpy(&s, parent, sizeof (state));
+                std::copy(parent + sizeof (state), parent + rsize - 1,
+                    c.begin());
+
+                for (char ch: alpha)
+                {
+                    if (ctl != nullptr && ctl->stopped())
+                        return;
+
+                    const state cs(con.step(s, ch));
+
+                    ++nodes;
+
+                    if (reject(con, cs, len))
+                        continue;
+
+                    c.back() = ch;
+
+                    if (con.accept(cs, len) &&
+                        (ctl == nullptr || ctl->claim()))
+                        std::cout << c << '\n';
+
+                    if (len < con.max_length)
+                    {
+                        std::memcpy(rec.data(), &cs, sizeof (state));
+                        std::copy(c.begin(), c.end(),
+                            rec.begin() + sizeof (state));
+                        nxt->push(rec.data());
+                    }
+                }
+            });
+
+        spilled += nxt->spilled();
+        cur = std::move(nxt);
+    }
+
+    if (spilled != 0)
+    {
+        std::cerr << '`' << __func__ << "` spilled ";
+        std::cerr << spilled << " bytes to disk" << std::endl;
+    }
+
+    return nodes;
+}
+catch (const std::runtime_error &e)
+{
+    std::cerr << "`std::runtime_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Performs compact non-recursive backtracking, using a Queue.
+/// @details Unlike `backtrack_que()`, which stores every candidate as its own
+///  `std::string` (32+ bytes, plus heap overhead), this function encodes each
+///  candidate as a 32-bit integer in bijective base `alphabet().length()`,
+///  whereby the characters are the digits `rank + 1`:
+///
+///      ""      -> 0
+///      "a"     -> 1
+///      "ab"    -> 1 * 36 + 2 = 38
+///
+///  For the 36 characters of `valid_chars`, all candidates up to length 6 fit
+///  into 32 bits, and memory use is lowered more than tenfold. Only candidates
+///  which weren't rejected and have children are stored, in a `chunk_queue`,
+///  so maximum lengths of up to 7 are supported.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] start               Beginning candidate, to start with.
+/// @param [in,out] ctl             Control of the search, if any.
+/// @returns Number of nodes checked, rejected or not.
+/// @throws std::overflow_error     If candidates cannot fit into 32 bits.
+///
+template <typename Constraint>
+std::uintmax_t backtrack_cmp(const Constraint &con, const std::string &start,
+    search_control *ctl = nullptr)
+try
+{
+    using state = typename Constraint::state;
+    using code  = std::uint32_t;
+
+    const std::string               &alpha  (con.alphabet());
+    const code                      base    (alpha.length());
+    std::array<code, UCHAR_MAX + 1> digit;
+    chunk_queue<code>               que;
+    std::string                     c;
+    std::uintmax_t                  nodes   (1);
+
+    digit.fill(0);
+
+    for (std::size_t i(0); i < alpha.length(); ++i)
+        digit[static_cast<unsigned char>(alpha[i])] =
+            static_cast<code>(i + 1);
+
+    //
+    // the largest code is that of a candidate of `max_length - 1` characters,
+    // (the longest that has children) all of them the last in the alphabet
+    //
+
+    for (std::uintmax_t max(0), len(0); len + 1 < con.max_length; ++len)
+    {
+        max = max * base + base;
+
+        if (max > std::numeric_limits<code>::max())
+            throw std::overflow_error("candidates do not fit into 32 bits");
+    }
+
+    const state s0(state_of(con, start));
+
+    if ((ctl != nullptr && ctl->stopped()) ||
+        reject(con, s0, start.length()))
+        return nodes;
+
+    if (con.accept(s0, start.length()) && (ctl == nullptr || ctl->claim()))
+        std::cout << start << '\n';
+
+    if (start.length() >= con.max_length)
+        return nodes;
+
+    {
+        code k(0);
+
+        for (char ch: start)
+            k = k * base + digit[static_cast<unsigned char>(ch)];
+
+        que.push(k);
+    }
+
+    c.reserve(con.max_length);
+
+    while (!que.empty() && (ctl == nullptr || !ctl->stopped()))
+    {
+        const code k(que.front());
+
+        que.pop();
+        c.clear();
+
+        for (code d(k); d != 0; d = (d - 1) / base)
+            c.push_back(alpha[(d - 1) % base]);
+
+        std::reverse(c.begin(), c.end());
+
+        const state s(state_of(con, c));
+
+        c.push_back('\0');
+
+        for (std::size_t r(0); r < alpha.length(); ++r)
+        {
+            if (ctl != nullptr && ctl->stopped())
+                break;
+
+            const state cs(con.step(s, alpha[r]));
+
+            ++nodes;
+
+            if (reject(con, cs, c.length()))
+                continue;
+
+            c.back() = alpha[r];
+
+            if (con.accept(cs, c.length()) && (ctl == nullptr || ctl->claim()))
+                std::cout << c << '\n';
+
+            if (c.length() < con.max_length)
+                que.push(k * base + static_cast<code>(r + 1));
+        }
+    }
+
+    return nodes;
+}
+catch (const std::overflow_error &e)
+{
+    std::cerr << "`std::overflow_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Item of the plan of a sharded search: either a solution shorter
+///  than the shards' prefixes, or the prefix of a shard.
+///
+struct plan_item
+{
+    std::string     c;          ///< Solution, or prefix of the shard.
+    bool            shard;      ///< Whether or not this is a shard.
+};
+
+///
+/// @brief Splits a search into shards, one per candidate of a given length
+///  which isn't rejected nor descends from a rejected candidate.
+/// @details The plan lists the shards and the shorter solutions in the order
+///  of the sequential search, so that concatenating them in that order gives
+///  the same output as `backtrack_frm()`.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in,out] c               Candidate, restored on return.
+/// @param [in] s                   State of the candidate.
+/// @param [in] length              Length of the prefixes of the shards, at
+///                                 most `con.max_length`.
+/// @param [in,out] plan            Plan, to which the items are appended.
+/// @returns Number of nodes checked, not counting the shards' prefixes.
+///
+template <typename Constraint>
+std::uintmax_t plan_shards(const Constraint &con, std::string &c,
+    typename Constraint::state s, std::size_t length,
+    std::vector<plan_item> &plan)
+{
+    assert(length <= con.max_length);
+
+    if (c.length() >= length)
+    {
+        plan.push_back(plan_item{c, true});
+        return 0;
+    }
+
+    std::uintmax_t nodes(1);
+
+    if (reject(con, s, c.length()))
+        return nodes;
+
+    if (con.accept(s, c.length()))
+        plan.push_back(plan_item{c, false});
+
+    for (char ch: con.alphabet())
+    {
+        c.push_back(ch);
+        nodes += plan_shards(con, c, con.step(s, ch), length, plan);
+        c.pop_back();
+    }
+
+    return nodes;
+}
+
+///
+/// @brief Writes a line to a socket, without raising `SIGPIPE` if the peer
+///  has gone away.
+/// @param [in] fd                  Socket.
+/// @param [in] line                Line to be written, without its `'\n'`.
+/// @returns Whether or not the line was written.
+///
+inline bool send_line(int fd, std::string line)
+{
+    line += '\n';
+
+    for (std::size_t i(0); i < line.size();)
+    {
+        const ssize_t w(::send(fd, line.data() + i, line.size() - i,
+            MSG_NOSIGNAL));
+
+        if (w < 0 && errno == EINTR)
+            continue;
+
+        if (w < 0)
+            return false;
+
+        i += static_cast<std::size_t>(w);
+    }
+
+    return true;
+}
+
+///
+/// @brief Reads the complete lines available from a socket.
+/// @param [in] fd                  Socket.
+/// @param [in,out] buf             Incomplete line from the previous call.
+/// @param [out] lines              Complete lines, without their `'\n'`.
+/// @returns Whether or not the socket is still open.
+///
+inline bool recv_lines(int fd, std::string &buf,
+    std::vector<std::string> &lines)
+{
+    char blk[4096];
+
+    lines.clear();
+
+    ssize_t r;
+
+    do
+        r = ::recv(fd, blk, sizeof blk, 0);
+    while (r < 0 && errno == EINTR);
+
+    if (r <= 0)
+        return false;
+
+    buf.append(blk, static_cast<std::size_t>(r));
+
+    for (std::size_t eol; (eol = buf.find('\n')) != std::string::npos;)
+    {
+        lines.push_back(buf.substr(0, eol));
+        buf.erase(0, eol + 1);
+    }
+
+    return true;
+}
+
+///
+/// @brief Returns the path of the file of a shard.
+///
+inline std::string shard_path(const std::string &dir, std::size_t id)
+{
+    return dir + "/shard-" + std::to_string(id) + ".txt";
+}
+
+///
+/// @brief Connects to a coordinator, and searches the shards it hands out
+///  until there are none left.
+/// @details The protocol is made of lines of text over a Unix-domain stream
+///  socket, so that workers can also be started by hand, e.g. in containers
+///  sharing the directory:
+///
+///      worker: GET                    // asks for a shard
+///      coord.: <id> <prefix>          // hands out a shard
+///      coord.: END                    // tells that all shards are done
+///      worker: DONE <id> <nodes>      // reports a shard as done
+///
+///  The solutions of a shard are written to a temporary file, which is only
+///  renamed to `shard_path()` once complete, before reporting it as done; so
+///  a worker that crashes never leaves a partial shard behind.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] dir                 Directory of the socket and shard files.
+/// @throws std::system_error       If the socket or a file fails.
+/// @throws std::runtime_error      If the coordinator's reply is malformed.
+///
+template <typename Constraint>
+void shard_worker(const Constraint &con, const std::string &dir)
+try
+{
+    const std::string path(dir + "/coordinator.sock");
+    sockaddr_un       addr;
+
+    std::memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+
+    if (path.length() >= sizeof addr.sun_path)
+        throw std::runtime_error("socket path too long");
+
+    std::memcpy(addr.sun_path, path.c_str(), path.length() + 1);
+
+    const int fd(::socket(AF_UNIX, SOCK_STREAM, 0));
+
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "socket");
+
+    try
+    {
+        if (::connect(fd, reinterpret_cast<const sockaddr *>(&addr),
+            sizeof addr) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(),
+                "connect");
+        }
+
+        std::string                 buf;
+        std::vector<std::string>    lines;
+        arena                       mem;
+
+        while (send_line(fd, "GET"))
+        {
+            while (lines.empty())
+                if (!recv_lines(fd, buf, lines))
+                    throw std::runtime_error("coordinator went away");
+
+            if (lines.size() != 1)
+                throw std::runtime_error("unexpected reply");
+
+            if (lines.front() == "END")
+                break;
+
+            const std::size_t sp(lines.front().find(' '));
+
+            if (sp == std::string::npos)
+                throw std::runtime_error("malformed reply");
+
+            const std::size_t   id  (std::stoul(lines.front().substr(0, sp)));
+            std::string         c   (lines.front().substr(sp + 1));
+            const std::string   tmp (shard_path(dir, id) + ".tmp");
+            const int           out (::open(tmp.c_str(),
+                O_WRONLY | O_CREAT | O_TRUNC, 0644));
+
+            lines.clear();
+
+            if (out < 0)
+                throw std::system_error(errno, std::generic_category(),
+                    "open");
+
+            std::uintmax_t nodes(0);
+
+            try
+            {
+                write_sink ws(out);
+
+                nodes = run_batched(ws,
+                    [&](const auto &emit)
+                    {
+                        return search_frm<Constraint>(con, c,
+                            state_of(con, c), emit, con.max_length, nullptr,
+                            nullptr, nullptr, &mem);
+                    });
+                ws.flush();
+            }
+            catch (...)
+            {
+                ::close(out);
+                throw;
+            }
+
+            ::close(out);
+
+            // nothing of the shard's search is alive anymore, so its memory
+            // is dropped at once, and the next shard starts afresh
+            mem.reset();
+
+            if (std::rename(tmp.c_str(), shard_path(dir, id).c_str()) != 0)
+                throw std::system_error(errno, std::generic_category(),
+                    "rename");
+
+            if (!send_line(fd, "DONE " + std::to_string(id) + ' ' +
+                std::to_string(nodes)))
+            {
+                break;
+            }
+        }
+    }
+    catch (...)
+    {
+        ::close(fd);
+        throw;
+    }
+
+    ::close(fd);
+}
+catch (const std::system_error &e)
+{
+    std::cerr << "`std::system_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (const std::runtime_error &e)
+{
+    std::cerr << "`std::runtime_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Performs backtracking with several processes: a coordinator, and
+///  workers which it forks.
+/// @details The search is split into shards by the prefixes of a given length
+///  (see `plan_shards()`), which the coordinator hands out to the workers over
+///  a Unix-domain socket, one at a time and on demand, so that faster workers
+///  take more of them (see `shard_worker()` for the protocol). If a worker
+///  disconnects before reporting its shard as done, e.g. because it crashed,
+///  the shard is handed out again, and a new worker is forked in place of a
+///  crashed one. At the end, the shard files and the shorter solutions are
+///  merged into the output in the order of the sequential search, so the
+///  output is the same as that of `backtrack_frm()`.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] start               Beginning candidate, to start with.
+/// @param [in] out_path            Path of the output file.
+/// @param [in] dir                 Existing directory for the socket and the
+///                                 shard files, all removed at the end.
+/// @param [in] num_workers         Number of worker processes.
+/// @param [in] length              Length of the prefixes of the shards; the
+///                                 length of `start` at least, and
+///                                 `con.max_length` at most.
+/// @param [in] max_attempts        Number of times a shard is handed out
+///                                 before giving up on it.
+/// @returns Number of nodes checked, rejected or not.
+/// @throws std::system_error       If a socket, process or file fails.
+/// @throws std::runtime_error      If a shard failed `max_attempts` times.
+///
+template <typename Constraint>
+std::uintmax_t backtrack_procs(const Constraint &con, const std::string &start,
+    const std::string &out_path, const std::string &dir,
+    unsigned int num_workers = 4, std::size_t length = 2,
+    unsigned int max_attempts = 3)
+try
+{
+    struct client
+    {
+        int             fd;
+        std::string     buf;            ///< Incomplete line received.
+        std::size_t     shard;          ///< Shard handed out, or `none`.
+        bool            waiting;        ///< Whether it waits for a shard.
+    };
+
+    constexpr std::size_t none(std::numeric_limits<std::size_t>::max());
+
+    std::vector<plan_item>      plan;
+    std::string                 c       (start);
+    std::uintmax_t              nodes   (plan_shards(con, c,
+        state_of(con, c), std::min(std::max(length, start.length()),
+        con.max_length), plan));
+    std::vector<std::size_t>    shards;
+
+    for (std::size_t i(0); i < plan.size(); ++i)
+        if (plan[i].shard)
+            shards.push_back(i);
+
+    std::vector<unsigned int>   attempts    (plan.size(), 0);
+    std::vector<bool>           done        (plan.size(), false);
+    std::deque<std::size_t>     todo        (shards.begin(), shards.end());
+    std::size_t                 left        (shards.size());
+    std::vector<client>         clients;
+    std::vector<pid_t>          workers;
+    const std::string           path        (dir + "/coordinator.sock");
+    sockaddr_un                 addr;
+
+    std::memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+
+    if (path.length() >= sizeof addr.sun_path)
+        throw std::runtime_error("socket path too long");
+
+    std::memcpy(addr.sun_path, path.c_str(), path.length() + 1);
+    ::unlink(path.c_str());
+
+    const int lfd(::socket(AF_UNIX, SOCK_STREAM, 0));
+
+    if (lfd < 0)
+        throw std::system_error(errno, std::generic_category(), "socket");
+
+    const auto spawn =
+        [&]()
+        {
+            std::cout.flush();
+            std::cerr.flush();
+
+            const pid_t pid(::fork());
+
+            if (pid < 0)
+                throw std::system_error(errno, std::generic_category(),
+                    "fork");
+
+            if (pid == 0)
+            {
+                int status(EXIT_SUCCESS);
+
+                ::close(lfd);
+
+                for (const client &cl: clients)
+                    ::close(cl.fd);
+
+                try
+                {
+                    shard_worker(con, dir);
+                }
+                catch (...)
+                {
+                    status = EXIT_FAILURE;
+                }
+
+                std::cout.flush();
+                ::_exit(status);
+            }
+
+            workers.push_back(pid);
+        };
+
+    const auto hand_out =
+        [&](client &cl)
+        {
+            if (!todo.empty())
+            {
+                cl.shard = todo.front();
+                cl.waiting = false;
+                todo.pop_front();
+
+                if (++attempts[cl.shard] > max_attempts)
+                    throw std::runtime_error("shard failed too many times");
+
+                send_line(cl.fd, std::to_string(cl.shard) + ' ' +
+                    plan[cl.shard].c);
+            }
+            else
+            if (left == 0)
+            {
+                cl.waiting = false;
+                send_line(cl.fd, "END");
+            }
+            else
+                cl.waiting = true;
+        };
+
+    try
+    {
+        if (::bind(lfd, reinterpret_cast<const sockaddr *>(&addr),
+            sizeof addr) != 0 || ::listen(lfd, SOMAXCONN) != 0)
+        {
+            throw std::system_error(errno, std::generic_category(), "bind");
+        }
+
+        for (unsigned int i(0); i < std::max(num_workers, 1u); ++i)
+            spawn();
+
+        std::vector<pollfd>         fds;
+        std::vector<std::string>    lines;
+
+        while (left != 0 || !workers.empty())
+        {
+            fds.assign(1, pollfd{lfd, POLLIN, 0});
+
+            for (const client &cl: clients)
+                fds.push_back(pollfd{cl.fd, POLLIN, 0});
+
+            if (::poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR)
+                throw std::system_error(errno, std::generic_category(),
+                    "poll");
+
+            if (fds[0].revents & POLLIN)
+            {
+                const int fd(::accept(lfd, nullptr, nullptr));
+
+                if (fd >= 0)
+                    clients.push_back(client{fd, std::string(), none, false});
+            }
+
+            for (std::size_t i(fds.size()); i-- > 1;)
+            {
+                if (fds[i].revents == 0)
+                    continue;
+
+                client &cl(clients[i - 1]);
+
+                if (!recv_lines(cl.fd, cl.buf, lines))
+                {
+                    //
+                    // the worker went away: hand out its shard again
+                    //
+                    if (cl.shard != none)
+                        todo.push_front(cl.shard);
+
+                    ::close(cl.fd);
+                    clients.erase(clients.begin() + (i - 1));
+                    continue;
+                }
+
+                for (const std::string &l: lines)
+                    if (l == "GET")
+                        hand_out(cl);
+                    else
+                    if (l.compare(0, 5, "DONE ") == 0)
+                    {
+                        std::size_t pos;
+
+                        const std::size_t id(std::stoul(l.substr(5), &pos));
+
+                        if (id != cl.shard)
+                            throw std::runtime_error("unexpected shard done");
+
+                        nodes += std::stoull(l.substr(5 + pos));
+                        done[id] = true;
+                        cl.shard = none;
+                        --left;
+                    }
+                    else
+                        throw std::runtime_error("unexpected request");
+            }
+
+            for (client &cl: clients)
+                if (cl.waiting && (!todo.empty() || left == 0))
+                    hand_out(cl);
+
+            //
+            // replace the workers which crashed, while there is work left;
+            // only our workers are waited for, not other children
+            //
+            for (std::size_t i(0); i < workers.size();)
+            {
+                int status;
+
+                if (::waitpid(workers[i], &status, WNOHANG) != workers[i])
+                {
+                    ++i;
+                    continue;
+                }
+
+                workers.erase(workers.begin() + i);
+
+                if (left != 0 && (!WIFEXITED(status) ||
+                    WEXITSTATUS(status) != EXIT_SUCCESS))
+                {
+                    spawn();
+                }
+            }
+
+            if (workers.empty() && left != 0)
+                spawn();
+        }
+    }
+    catch (...)
+    {
+        for (const client &cl: clients)
+            ::close(cl.fd);
+
+        ::close(lfd);
+        ::unlink(path.c_str());
+
+        for (pid_t pid: workers)
+        {
+            ::kill(pid, SIGTERM);
+            ::waitpid(pid, nullptr, 0);
+        }
+
+        throw;
+    }
+
+    for (const client &cl: clients)
+        ::close(cl.fd);
+
+    ::close(lfd);
+    ::unlink(path.c_str());
+
+    for (pid_t pid: workers)
+        ::waitpid(pid, nullptr, 0);
+
+    //
+    // merge the shard files and the shorter solutions, in order
+    //
+    const int out(::open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+        0644));
+
+    if (out < 0)
+        throw std::system_error(errno, std::generic_category(), "open");
+
+    try
+    {
+        write_sink      ws  (out);
+        solution_batch  b;
+        std::string     text;
+
+        for (std::size_t i(0); i < plan.size(); ++i)
+        {
+            if (!plan[i].shard)
+            {
+                b.add(plan[i].c);
+                ws.consume(b);
+                b.clear();
+                continue;
+            }
+
+            const std::string   sp  (shard_path(dir, i));
+            const int           in  (::open(sp.c_str(), O_RDONLY));
+
+            if (in < 0)
+                throw std::system_error(errno, std::generic_category(),
+                    "open");
+
+            ws.flush();
+
+            char blk[1 << 16];
+
+            for (ssize_t r; (r = ::read(in, blk, sizeof blk)) != 0;)
+            {
+                if (r < 0 && errno == EINTR)
+                    continue;
+
+                if (r < 0)
+                {
+                    const int e(errno);
+
+                    ::close(in);
+                    throw std::system_error(e, std::generic_category(),
+                        "read");
+                }
+
+                write_all(out, blk, static_cast<std::size_t>(r));
+            }
+
+            ::close(in);
+            ::unlink(sp.c_str());
+        }
+
+        ws.flush();
+    }
+    catch (...)
+    {
+        ::close(out);
+        throw;
+    }
+
+    ::close(out);
+    return nodes;
+}
+catch (const std::system_error &e)
+{
+    std::cerr << "`std::system_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (const std::runtime_error &e)
+{
+    std::cerr << "`std::runtime_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Counts the solutions, by length, without enumerating them.
+/// @details Candidates of the same length and with the same constraint state
+///  have the same future, so instead of candidates, this function keeps track
+///  of how many candidates of the current length are in each state (Dynamic
+///  Programming). Each length is thus handled in O(num_states * alphabet).
+/// @warning The counts overflow if there are more than `UINTMAX_MAX` of them,
+///  e.g. for lengths above 12 with the 36 characters of `valid_chars`.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] start               Beginning candidate, to start with.
+/// @returns Number of solutions, indexed by length.
+///
+template <typename Constraint>
+std::vector<std::uintmax_t> count_solutions(const Constraint &con,
+    const std::string &start = "")
+try
+{
+    using state = typename Constraint::state;
+
+    const std::string           &alpha  (con.alphabet());
+    std::vector<std::uintmax_t> r       (con.max_length + 1, 0);
+    std::vector<std::uintmax_t> cnt     (con.num_states, 0);
+    std::vector<std::uintmax_t> nxt     (con.num_states, 0);
+    std::vector<state>          st      (con.num_states, con.initial());
+    const state                 s0      (state_of(con, start));
+
+    cnt[con.index(s0)] = 1;
+    st[con.index(s0)] = s0;
+
+    for (std::size_t len(start.length()); len <= con.max_length; ++len)
+    {
+        std::fill(nxt.begin(), nxt.end(), 0);
+
+        for (std::size_t i(0); i < cnt.size(); ++i)
+        {
+            if (cnt[i] == 0 || reject(con, st[i], len))
+                continue;
+
+            if (con.accept(st[i], len))
+                r[len] += cnt[i];
+
+            if (len == con.max_length)
+                continue;
+
+            for (char ch: alpha)
+            {
+                const state         s   (con.step(st[i], ch));
+                const std::size_t   j   (con.index(s));
+
+                nxt[j] += cnt[i];
+                st[j] = s;
+            }
+        }
+
+        cnt.swap(nxt);
+    }
+
+    return r;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Hash table from 64-bit keys to 64-bit values, with open addressing
+///  and linear probing.
+/// @details Slots are 16 bytes and stored in a single array, whose size is a
+///  power of two, doubled whenever it gets half full.
+///
+class memo_table
+{
+public:
+
+    ///
+    /// @brief Value returned by `find()` for a missing key.
+    ///
+    static constexpr std::uint64_t missing =
+        std::numeric_limits<std::uint64_t>::max();
+
+    ///
+    /// @brief Creates the table.
+    /// @param [in] capacity        Initial number of slots; will be rounded
+    ///                             up to a power of two.
+    ///
+    explicit memo_table(std::size_t capacity = 1 << 12)
+    {
+        while ((std::size_t(1) << bits) < capacity)
+            ++bits;
+
+        slots.assign(std::size_t(1) << bits, slot{0, 0});
+    }
+
+    ///
+    /// @brief Finds the value of a key.
+    /// @param [in] key             Key to be found.
+    /// @returns Value of the key, or `missing` if the key is not in the table.
+    ///
+    std::uint64_t find(std::uint64_t key) const
+    {
+        const std::size_t mask(slots.size() - 1);
+
+        for (std::size_t i(hash(key)); ; i = (i + 1) & mask)
+        {
+            if (slots[i].key == key + 1)
+                return slots[i].value;
+
+            if (slots[i].key == 0)
+                return missing;
+        }
+    }
+
+    ///
+    /// @brief Inserts a key, or overwrites its value.
+    /// @param [in] key             Key to be inserted, below `UINT64_MAX`.
+    /// @param [in] value           Value of the key.
+    ///
+    void insert(std::uint64_t key, std::uint64_t value)
+    {
+        assert(key != std::numeric_limits<std::uint64_t>::max());
+
+        if (2 * (used + 1) > slots.size())
+            grow();
+
+        slot &sl(probe(key));
+
+        if (sl.key == 0)
+        {
+            sl.key = key + 1;
+            ++used;
+        }
+
+        sl.value = value;
+    }
+
+    std::size_t size() const
+    {
+        return used;
+    }
+
+private:
+
+    ///
+    /// @brief Slot of the table; keys are stored plus one, so that zero marks
+    ///  an empty slot.
+    ///
+    struct slot
+    {
+        std::uint64_t   key;
+        std::uint64_t   value;
+    };
+
+    std::size_t hash(std::uint64_t key) const
+    {
+        // Fibonacci hashing: the high bits of the product are the best mixed
+        return static_cast<std::size_t>(
+            (key * UINT64_C(0x9e3779b97f4a7c15)) >> (64 - bits));
+    }
+
+    slot & probe(std::uint64_t key)
+    {
+        const std::size_t mask(slots.size() - 1);
+        std::size_t       i   (hash(key));
+
+        while (slots[i].key != 0 && slots[i].key != key + 1)
+            i = (i + 1) & mask;
+
+        return slots[i];
+    }
+
+    void grow()
+    {
+        std::vector<slot> old(std::size_t(2) << bits, slot{0, 0});
+
+        old.swap(slots);
+        ++bits;
+
+        for (const slot &sl: old)
+            if (sl.key != 0)
+                probe(sl.key - 1) = sl;
+    }
+
+    std::vector<slot>   slots;
+    std::size_t         used    = 0;
+    unsigned int        bits    = 1;
+};
+
+///
+/// @brief Returns the key of a subtree in a `memo_table`.
+/// @details The subtree of a candidate only depends on its constraint state
+///  and on the number of characters which can still be appended, so those are
+///  the key.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] s                   State of the candidate.
+/// @param [in] len                 Length of the candidate.
+/// @returns Key of the subtree.
+///
+template <typename Constraint>
+std::uint64_t memo_key(const Constraint &con,
+    const typename Constraint::state &s, std::size_t len)
+{
+    return static_cast<std::uint64_t>(con.index(s)) * (con.max_length + 1) +
+        (con.max_length - len);
+}
+
+///
+/// @brief Performs non-recursive backtracking, using frames, and skipping the
+///  subtrees already known to hold no solution.
+/// @details Like `search_frm()`, but when the last child of a frame was tried,
+///  the number of solutions found below the frame's candidate is recorded in
+///  `memo` under the key of its subtree. A candidate is then only descended
+///  into if its subtree is not known to be empty; so each empty subtree is
+///  searched at most once per (state, remaining depth), instead of once per
+///  candidate, which makes the search polynomial in the number of solutions
+///  for constraints with few states.
+///
+///  The solutions not output because of the control are still counted, and
+///  the subtrees left unfinished when the search stops are not recorded, so
+///  the table stays exact.
+/// @tparam Constraint              Constraint type, with `index()`.
+/// @tparam Emit                    Callable type, taking a solution.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in,out] c               Beginning candidate, restored on return.
+/// @param [in] s                   State of the beginning candidate.
+/// @param [in] emit                Function to be called for each solution.
+/// @param [in,out] memo            Table of the solutions below a subtree,
+///                                 shareable with `count_memo()`.
+/// @param [in,out] ctl             Control of the search, if any.
+/// @returns Number of nodes checked, rejected or not.
+///
+template <typename Constraint, typename Emit>
+std::uintmax_t search_memo(const Constraint &con, std::string &c,
+    typename Constraint::state s, Emit &&emit, memo_table &memo,
+    search_control *ctl = nullptr)
+try
+{
+    using state = typename Constraint::state;
+
+    struct frame
+    {
+        std::size_t     next;       ///< Index of the next character to try.
+        state           s;          ///< State of the prefix at this level.
+        std::uintmax_t  found;      ///< Solutions found before this level.
+    };
+
+    const std::string   &alpha  (con.alphabet());
+    std::vector<frame>  frm;
+    std::uintmax_t      nodes   (1);
+    std::uintmax_t      sols    (0);
+    const std::size_t   root    (c.length());
+
+    c.reserve(con.max_length);
+    frm.reserve(con.max_length + 1);
+
+    if ((ctl != nullptr && ctl->stopped()) || reject(con, s, c.length()))
+        return nodes;
+
+    if (con.accept(s, c.length()))
+    {
+        ++sols;
+
+        if (ctl == nullptr || ctl->claim())
+            emit(c);
+    }
+
+    if (c.length() < con.max_length &&
+        memo.find(memo_key(con, s, c.length())) != 0)
+    {
+        frm.push_back(frame{0, s, sols});
+    }
+
+    while (!frm.empty())
+    {
+        if (ctl != nullptr && ctl->stopped())
+        {
+            c.resize(root);
+            break;
+        }
+
+        //
+        // all the children of the current prefix were tried,
+        // so remember how many solutions its subtree holds
+        //
+        if (frm.back().next == alpha.length())
+        {
+            memo.insert(memo_key(con, frm.back().s, c.length()),
+                sols - frm.back().found);
+            frm.pop_back();
+
+            if (!frm.empty())
+                c.pop_back();
+
+            continue;
+        }
+
+        const char ch(alpha[frm.back().next++]);
+
+        s = con.step(frm.back().s, ch);
+        c.push_back(ch);
+        ++nodes;
+
+        if (reject(con, s, c.length()))
+        {
+            c.pop_back();
+            continue;
+        }
+
+        if (con.accept(s, c.length()))
+        {
+            ++sols;
+
+            if (ctl == nullptr || ctl->claim())
+                emit(c);
+        }
+
+        if (c.length() < con.max_length &&
+            memo.find(memo_key(con, s, c.length())) != 0)
+        {
+            frm.push_back(frame{0, s, sols});
+        }
+        else
+            c.pop_back();
+    }
+
+    return nodes;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Performs non-recursive backtracking, using frames, and skipping the
+///  subtrees already known to hold no solution.
+/// @see `search_memo()`
+/// @tparam Constraint              Constraint type, with `index()`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] start               Beginning candidate, to start with.
+/// @param [in,out] ctl             Control of the search, if any.
+/// @returns Number of nodes checked, rejected or not.
+///
+template <typename Constraint>
+std::uintmax_t backtrack_memo(const Constraint &con, const std::string &start,
+    search_control *ctl = nullptr)
+try
+{
+    std::string c       (start);
+    memo_table  memo;
+
+    return search_memo(con, c, state_of(con, c),
+        [](const std::string &sol)
+        {
+            std::cout << sol << '\n';
+        },
+        memo, ctl);
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Returns the number of solutions strictly below a candidate.
+/// @details The count is memoized under the key of the candidate's subtree,
+///  so it is computed once per (state, remaining depth).
+/// @tparam Constraint              Constraint type, with `index()`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] s                   State of the candidate.
+/// @param [in] len                 Length of the candidate.
+/// @param [in,out] memo            Table of the solutions below a subtree.
+/// @returns Number of solutions.
+///
+template <typename Constraint>
+std::uintmax_t count_below(const Constraint &con,
+    const typename Constraint::state &s, std::size_t len, memo_table &memo)
+{
+    if (len >= con.max_length)
+        return 0;
+
+    const std::uint64_t key (memo_key(con, s, len));
+    std::uint64_t       n   (memo.find(key));
+
+    if (n != memo_table::missing)
+        return n;
+
+    n = 0;
+
+    for (char ch: con.alphabet())
+    {
+        const typename Constraint::state t(con.step(s, ch));
+
+        if (reject(con, t, len + 1))
+            continue;
+
+        if (con.accept(t, len + 1))
+            ++n;
+
+        n += count_below(con, t, len + 1, memo);
+    }
+
+    memo.insert(key, n);
+    return n;
+}
+
+///
+/// @brief Counts the solutions, with a memoized search.
+/// @details Unlike `count_solutions()`, only the (state, remaining depth)
+///  pairs actually reachable are visited, and `num_states` is not needed.
+/// @warning The count overflows like that of `count_solutions()`.
+/// @tparam Constraint              Constraint type, with `index()`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] start               Beginning candidate, to start with.
+/// @returns Number of solutions.
+///
+template <typename Constraint>
+std::uintmax_t count_memo(const Constraint &con, const std::string &start = "")
+try
+{
+    using state = typename Constraint::state;
+
+    const state s   (state_of(con, start));
+    memo_table  memo;
+
+    if (reject(con, s, start.length()))
+        return 0;
+
+    return (con.accept(s, start.length()) ? 1 : 0) +
+        count_below(con, s, start.length(), memo);
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Index of all the solutions, in the order of the sequential search.
+/// @details For every length and state, the number of solutions in the subtree
+///  of a candidate with that length and state is computed up front, like in
+///  `count_solutions()`. Then:
+///  - the rank of a solution is found by adding up the solutions of all the
+///    subtrees which precede it in the search, and
+///  - the solution of a rank is found by descending into the only subtree
+///    which contains it,
+///  both in O(length), without enumerating anything. This allows random access
+///  to solutions, uniform random sampling, and splitting the solutions into
+///  equally sized shards, e.g. one per process.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+///
+template <typename Constraint>
+class solution_index
+{
+public:
+
+    using state = typename Constraint::state;
+
+    ///
+    /// @brief Builds the index.
+    /// @param [in] con             Constraint to be satisfied.
+    ///
+    explicit solution_index(const Constraint &con):
+        con(con),
+        st(con.num_states, con.initial()),
+        below(con.max_length + 1)
+    {
+        const std::string   &alpha  (con.alphabet());
+        std::vector<bool>   seen    (con.num_states, false);
+
+        seen[con.index(con.initial())] = true;
+
+        //
+        // discover all the states, as their indices are all we know of them
+        //
+
+        for (bool more(true); more;)
+        {
+            more = false;
+
+            for (std::size_t i(0); i < st.size(); ++i)
+            {
+                if (!seen[i])
+                    continue;
+
+                for (char ch: alpha)
+                {
+                    const state         s   (con.step(st[i], ch));
+                    const std::size_t   j   (con.index(s));
+
+                    if (!seen[j])
+                    {
+                        seen[j] = more = true;
+                        st[j] = s;
+                    }
+                }
+            }
+        }
+
+        //
+        // from the deepest level up, count the solutions of every subtree,
+        // keeping the running sums over the children, in alphabet order
+        //
+
+        std::vector<std::uintmax_t> sub(con.num_states, 0);
+
+        for (std::size_t len(con.max_length + 1); len-- != 0;)
+        {
+            std::vector<std::uintmax_t> cur(con.num_states, 0);
+
+            below[len].assign(con.num_states * (alpha.length() + 1), 0);
+
+            for (std::size_t i(0); i < st.size(); ++i)
+            {
+                if (!seen[i] || reject(con, st[i], len))
+                    continue;
+
+                std::uintmax_t *b(&below[len][i * (alpha.length() + 1)]);
+
+                if (len < con.max_length)
+                    for (std::size_t r(0); r < alpha.length(); ++r)
+                        b[r + 1] = b[r] + sub[con.index(
+                            con.step(st[i], alpha[r]))];
+
+                cur[i] = b[alpha.length()] + con.accept(st[i], len);
+            }
+
+            sub.swap(cur);
+        }
+
+        total = sub[con.index(con.initial())];
+    }
+
+    ///
+    /// @brief Returns the number of solutions.
+    ///
+    std::uintmax_t size() const
+    {
+        return total;
+    }
+
+    ///
+    /// @brief Returns the rank of a solution.
+    /// @pre `c` is a solution.
+    /// @param [in] c           Solution.
+    /// @returns Number of solutions preceding `c`.
+    ///
+    std::uintmax_t rank(const std::string &c) const
+    {
+        std::uintmax_t  r   (0);
+        state           s   (con.initial());
+
+        for (std::size_t len(0); len < c.length(); ++len)
+        {
+            const std::size_t ch_rank(con.alphabet().find(c[len]));
+
+            assert(ch_rank != std::string::npos);
+
+            r += con.accept(s, len) + children(len, s)[ch_rank];
+            s = con.step(s, c[len]);
+        }
+
+        return r;
+    }
+
+    ///
+    /// @brief Returns the solution of a rank.
+    /// @pre `r < size()`
+    /// @param [in] r           Rank of the solution.
+    /// @returns Solution.
+    ///
+    std::string unrank(std::uintmax_t r) const
+    {
+        assert(r < size());
+
+        const std::string   &alpha  (con.alphabet());
+        std::string         c;
+        state               s       (con.initial());
+
+        c.reserve(con.max_length);
+
+        while (true)
+        {
+            if (con.accept(s, c.length()))
+            {
+                if (r == 0)
+                    return c;
+
+                --r;
+            }
+
+            const std::uintmax_t *b(children(c.length(), s));
+            const std::size_t ch_rank(
+                std::upper_bound(b, b + alpha.length() + 1, r) - b - 1);
+
+            r -= b[ch_rank];
+            c.push_back(alpha[ch_rank]);
+            s = con.step(s, alpha[ch_rank]);
+        }
+    }
+
+    ///
+    /// @brief Returns a solution chosen uniformly at random.
+    /// @pre `size() != 0`
+    /// @tparam PRNG            Pseudo-random number generator type.
+    /// @param [in,out] prng    Pseudo-random number generator.
+    /// @returns Solution.
+    ///
+    template <typename PRNG>
+    std::string sample(PRNG &prng) const
+    {
+        return unrank(std::uniform_int_distribution<std::uintmax_t>(
+            0, size() - 1)(prng));
+    }
+
+    ///
+    /// @brief Returns the range of ranks of a shard.
+    /// @details The shards differ in size by at most one solution.
+    /// @pre `i < n`
+    /// @param [in] i           Index of the shard.
+    /// @param [in] n           Number of shards.
+    /// @returns First rank, and one past the last rank of the shard.
+    ///
+    std::pair<std::uintmax_t, std::uintmax_t> shard(std::uintmax_t i,
+        std::uintmax_t n) const
+    {
+        assert(i < n);
+
+        const auto first =
+            [this, n](std::uintmax_t k) -> std::uintmax_t
+            {
+                return total / n * k + std::min(k, total % n);
+            };
+
+        return std::make_pair(first(i), first(i + 1));
+    }
+
+    ///
+    /// @brief Calls a function for each solution of rank in `[lo, hi)`.
+    /// @details Subtrees with no solutions in range are skipped as a whole.
+    /// @tparam Emit            Callable type, taking a solution.
+    /// @param [in] lo          First rank.
+    /// @param [in] hi          One past the last rank.
+    /// @param [in] emit        Function to be called for each solution.
+    ///
+    template <typename Emit>
+    void for_each(std::uintmax_t lo, std::uintmax_t hi, Emit &&emit) const
+    {
+        std::string c;
+
+        c.reserve(con.max_length);
+
+        if (lo < hi)
+            for_each(c, con.initial(), 0, lo, hi, emit);
+    }
+
+private:
+
+    ///
+    /// @brief Returns the running sums of solutions of the children.
+    /// @details Element `r` is the number of solutions in the subtrees of all
+    ///  the children with a last character of rank lower than `r`.
+    ///
+    const std::uintmax_t * children(std::size_t len, const state &s) const
+    {
+        return &below[len][con.index(s) * (con.alphabet().length() + 1)];
+    }
+
+    template <typename Emit>
+    void for_each(std::string &c, const state &s, std::uintmax_t off,
+        std::uintmax_t lo, std::uintmax_t hi, Emit &emit) const
+    {
+        if (con.accept(s, c.length()))
+        {
+            if (off >= lo)
+                emit(c);
+
+            ++off;
+        }
+
+        if (c.length() == con.max_length)
+            return;
+
+        const std::string       &alpha  (con.alphabet());
+        const std::uintmax_t    *b      (children(c.length(), s));
+
+        for (std::size_t r(0); r < alpha.length() && off + b[r] < hi; ++r)
+        {
+            if (off + b[r + 1] <= lo || b[r + 1] == b[r])
+                continue;
+
+            c.push_back(alpha[r]);
+            for_each(c, con.step(s, alpha[r]), off + b[r], lo, hi, emit);
+            c.pop_back();
+        }
+    }
+
+    const Constraint                            con;
+    std::vector<state>                          st;
+    std::vector<std::vector<std::uintmax_t>>    below;
+    std::uintmax_t                              total;
+};
+
+///
+/// @brief Prints the solutions of one shard, out of equally sized shards.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] i                   Index of the shard.
+/// @param [in] n                   Number of shards.
+///
+template <typename Constraint>
+void backtrack_shard(const Constraint &con, std::uintmax_t i, std::uintmax_t n)
+try
+{
+    const solution_index<Constraint>                    idx (con);
+    const std::pair<std::uintmax_t, std::uintmax_t>     rng (idx.shard(i, n));
+
+    idx.for_each(rng.first, rng.second,
+        [](const std::string &sol)
+        {
+            std::cout << sol << '\n';
+        });
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Prints solutions chosen uniformly at random, along with their ranks.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+/// @param [in] n                   Number of solutions to be printed.
+///
+template <typename Constraint>
+void sample(const Constraint &con, std::size_t n)
+try
+{
+    const solution_index<Constraint> idx(con);
+
+    std::mt19937_64 prng(
+        std::chrono::system_clock::now().time_since_epoch().count());
+
+    std::cout << "solutions: " << idx.size() << '\n';
+
+    for (std::size_t i(0); i < n; ++i)
+    {
+        const std::string sol(idx.sample(prng));
+
+        std::cout << "rank " << idx.rank(sol) << ": " << sol << '\n';
+    }
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Counts the solutions and prints their numbers, by length, then
+///  their total as counted by `count_memo()`.
+/// @tparam Constraint              Constraint type, see `password_constraint`.
+/// @param [in] con                 Constraint to be satisfied.
+///
+template <typename Constraint>
+void count(const Constraint &con)
+try
+{
+    const auto                          start   (
+        std::chrono::steady_clock::now());
+    const std::vector<std::uintmax_t>   r       (count_solutions(con));
+    const auto                          stop    (
+        std::chrono::steady_clock::now());
+
+    std::uintmax_t total(0);
+
+    for (std::size_t len(0); len < r.size(); ++len)
+    {
+        std::cout << "length " << len << ": " << r[len] << '\n';
+        total += r[len];
+    }
+
+    std::cout << "total: " << total << '\n';
+    std::cout << "time: ";
+    std::cout << std::chrono::duration_cast<std::chrono::microseconds>(
+        stop - start).count() << " us" << std::endl;
+
+    const auto              start_memo  (std::chrono::steady_clock::now());
+    const std::uintmax_t    total_memo  (count_memo(con));
+    const auto              stop_memo   (std::chrono::steady_clock::now());
+
+    std::cout << "memoized total: " << total_memo << '\n';
+    std::cout << "time: ";
+    std::cout << std::chrono::duration_cast<std::chrono::microseconds>(
+        stop_memo - start_memo).count() << " us" << std::endl;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Reads candidates from `std::cin`, one per line, and prints those
+///  which are solutions.
+/// @details The whole input is read at once, then checked line by line.
+///
+[[maybe_unused]]
+void check_candidates()
+try
+{
+    const std::string in(std::istreambuf_iterator<char>(std::cin), {});
+
+    std::string_view    rest    (in);
+    std::string         c;
+
+    while (!rest.empty())
+    {
+        const std::size_t eol(std::min(rest.find('\n'), rest.length()));
+
+        c.assign(rest.data(), eol);
+        rest.remove_prefix(std::min(eol + 1, rest.length()));
+
+        if (!reject(c) && accept(c))
+            std::cout << c << '\n';
+    }
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Solves N-Queens and Sudoku problems, and checks the solutions
+///  against the known ones.
+/// @throws std::runtime_error      If a number of solutions or a solution is
+///                                 not the known one.
+///
+[[maybe_unused]]
+void check_problems()
+try
+{
+    //
+    // number of solutions for n = 1, 2, ... (OEIS A000170)
+    //
+    constexpr std::array<std::uintmax_t, 10> queens{
+        1, 0, 0, 2, 10, 4, 40, 92, 352, 724};
+
+    for (unsigned int n(1); n <= queens.size(); ++n)
+    {
+        const queens_problem    prob    (n);
+        std::uintmax_t          sols    (0);
+
+        backtrack<call_stack>(prob, prob.make_node(),
+            [&sols](std::string_view)
+            {
+                ++sols;
+            });
+
+        if (sols != queens[n - 1])
+            throw std::runtime_error("wrong number of N-Queens solutions "
+                "for n = " + std::to_string(n));
+    }
+
+    const std::array<std::pair<const char *, const char *>, 2> sudokus{{
+        {hard_sudoku,
+            "812753649943682175675491283154237896369845721287169534521974368"
+            "438526917796318452"},
+        {sparse_sudoku,
+            "693784512487512936125963874932651487568247391741398625319475268"
+            "856129743274836159"}}};
+
+    //
+    // the orderings change the order of the search, not its solutions
+    //
+    const auto check_sudoku =
+        [](const auto &prob, const char *grid, const char *solution)
+        {
+            std::vector<std::string> sols;
+
+            backtrack<call_stack>(prob, prob.make_node(grid),
+                [&sols](std::string_view sol)
+                {
+                    sols.emplace_back(sol);
+                });
+
+            if (sols.size() != 1 || sols.front() != solution)
+                throw std::runtime_error("wrong Sudoku solution");
+        };
+
+    for (const auto &p: sudokus)
+    {
+        check_sudoku(sudoku_problem<>(), p.first, p.second);
+        check_sudoku(sudoku_problem<true>(), p.first, p.second);
+        check_sudoku(sudoku_problem<false, true>(), p.first, p.second);
+        check_sudoku(sudoku_problem<true, true>(), p.first, p.second);
+    }
+
+    std::cerr << "N-Queens and Sudoku solutions are the known ones";
+    std::cerr << std::endl;
+}
+catch (const std::runtime_error &e)
+{
+    std::cerr << "`std::runtime_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Runs `backtrack_procs()` with shards of several lengths, up to
+///  longer than the candidates, and checks that its output and number of
+///  nodes are those of `search_frm()`.
+/// @throws std::system_error       If the temporary directory or the output
+///                                 cannot be made or read.
+/// @throws std::runtime_error      If an output or a number of nodes is not
+///                                 that of `search_frm()`.
+///
+[[maybe_unused]]
+void check_shards()
+try
+{
+    //
+    // a small alphabet keeps the number of shards, and of round trips to the
+    // coordinator, low
+    //
+    const dfa_constraint con(constraint_spec{"b01", 3, 6,
+        {{2, "01"}, {1, "b"}}, {"bb"}});
+
+    std::string             c;
+    std::string             expected;
+    const std::uintmax_t    nodes   (search_frm(con, c, state_of(con, c),
+        [&expected](const std::string &sol)
+        {
+            expected += sol;
+            expected += '\n';
+        }));
+
+    char tmpl[] = "/tmp/backtrack.XXXXXX";
+
+    if (::mkdtemp(tmpl) == nullptr)
+        throw std::system_error(errno, std::generic_category(), "mkdtemp");
+
+    const std::string dir(tmpl), out(dir + "/solutions.txt");
+
+    try
+    {
+        for (std::size_t length: {std::size_t(0), std::size_t(2),
+            con.max_length, con.max_length + 2})
+        {
+            const std::uintmax_t n(backtrack_procs(con, "", out, dir, 2,
+                length));
+
+            std::FILE   *file   (std::fopen(out.c_str(), "rb"));
+            std::string got;
+            char        blk[4096];
+
+            if (file == nullptr)
+                throw std::system_error(errno, std::generic_category(),
+                    "fopen");
+
+            for (std::size_t r; (r = std::fread(blk, 1, sizeof blk, file));)
+                got.append(blk, r);
+
+            std::fclose(file);
+            ::unlink(out.c_str());
+
+            if (got != expected || n != nodes)
+                throw std::runtime_error("wrong output of `backtrack_procs()` "
+                    "with shards of length " + std::to_string(length));
+        }
+    }
+    catch (...)
+    {
+        ::unlink(out.c_str());
+        ::rmdir(dir.c_str());
+        throw;
+    }
+
+    ::rmdir(dir.c_str());
+    std::cerr << "`backtrack_procs()` output is that of `search_frm()`";
+    std::cerr << std::endl;
+}
+catch (const std::system_error &e)
+{
+    std::cerr << "`std::system_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (const std::runtime_error &e)
+{
+    std::cerr << "`std::runtime_error` exception in `" << __func__ << "`: ";
+    std::cerr << e.what() << std::endl;
+    throw;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Runs a backtracking function and prints how long it took.
+/// @details The time is printed to `std::cerr`, so as to not be mixed with
+///  the solutions printed to `std::cout`. If the function returns the number
+///  of nodes it checked, that is printed as well.
+/// @tparam F                       Callable type, taking a start candidate.
+/// @param [in] name                Name of the function, to be printed.
+/// @param [in] f                   Backtracking function to be benchmarked.
+///
+template <typename F>
+void benchmark(const char *name, F f)
+try
+{
+    using result = decltype(f(""));
+
+    const auto      start   (std::chrono::steady_clock::now());
+    std::uintmax_t  nodes   (0);
+
+    if constexpr (std::is_void<result>::value)
+        f("");
+    else
+        nodes = f("");
+
+    std::cout.flush();
+
+    const auto stop(std::chrono::steady_clock::now());
+
+    std::cerr << name << ": ";
+    std::cerr << std::chrono::duration_cast<std::chrono::milliseconds>(
+        stop - start).count() << " ms";
+
+    if (nodes != 0)
+        std::cerr << ", " << nodes << " nodes";
+
+    std::cerr << std::endl;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Solves a problem with `backtrack()` and prints how long it took,
+///  along with the numbers of nodes and solutions.
+/// @details The solutions are only counted, so the rate is that of the search.
+/// @tparam Frontier                Frontier policy, see `backtrack()`.
+/// @tparam Problem                 Problem policy, see `backtrack()`.
+/// @param [in] name                Name of the problem, to be printed.
+/// @param [in] prob                Problem to be solved.
+/// @param [in] root                Beginning node, to start with.
+/// @param [in] limit               Number of solutions after which to stop.
+///
+template <template <typename> class Frontier = call_stack, typename Problem>
+void benchmark_problem(const char *name, const Problem &prob,
+    const typename Problem::node &root,
+    std::uintmax_t limit = std::numeric_limits<std::uintmax_t>::max())
+try
+{
+    search_control  ctl     (limit);
+    std::uintmax_t  sols    (0);
+    const auto      start   (std::chrono::steady_clock::now());
+
+    const std::uintmax_t nodes(backtrack<Frontier>(prob, root,
+        [&sols](std::string_view)
+        {
+            ++sols;
+        },
+        &ctl));
+
+    const auto stop(std::chrono::steady_clock::now());
+    const auto us(std::chrono::duration_cast<std::chrono::microseconds>(
+        stop - start).count());
+
+    std::cerr << name << ": " << us / 1000 << " ms, " << nodes << " nodes, ";
+    std::cerr << sols << " solutions";
+
+    if (us != 0)
+        std::cerr << ", " << 1e6 * sols / us << " solutions/s";
+
+    std::cerr << std::endl;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Finds a solution with `backtrack_luby()` over many seeds, and prints
+///  the distribution of the time to the first solution.
+/// @details The median, 90th and 99th percentiles and maximum are printed, in
+///  nodes and in microseconds; the tail percentiles are those that restarts
+///  are meant to bring down.
+/// @tparam Problem                 Problem policy, see `backtrack()`.
+/// @param [in] name                Name of the problem, to be printed.
+/// @param [in] prob                Problem to be solved.
+/// @param [in] root                Beginning node, to start with.
+/// @param [in] unit                Number of nodes of the shortest runs.
+/// @param [in] runs                Number of runs, with seeds 1, 2, 3...
+///
+template <typename Problem>
+void benchmark_first(const char *name, const Problem &prob,
+    const typename Problem::node &root, std::uintmax_t unit,
+    std::size_t runs = 1000)
+try
+{
+    std::vector<std::uintmax_t> nodes   (runs);
+    std::vector<std::uintmax_t> us      (runs);
+
+    for (std::size_t i(0); i < runs; ++i)
+    {
+        const auto start(std::chrono::steady_clock::now());
+
+        nodes[i] = backtrack_luby(prob, root, [](std::string_view) {}, i + 1,
+            unit);
+        us[i] = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::sort(nodes.begin(), nodes.end());
+    std::sort(us.begin(), us.end());
+
+    const auto print =
+        [runs](const std::vector<std::uintmax_t> &v, const char *unit_name)
+        {
+            std::cerr << "  p50 " << v[runs / 2];
+            std::cerr << ", p90 " << v[runs * 9 / 10];
+            std::cerr << ", p99 " << v[runs * 99 / 100] << ", max ";
+            std::cerr << v.back() << ' ' << unit_name << '\n';
+        };
+
+    std::cerr << name << ", " << runs << " runs:\n";
+    print(nodes, "nodes");
+    print(us, "us");
+    std::cerr.flush();
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+///
+/// @brief Runs a backtracking function and prints its telemetry.
+/// @details The report is printed to `std::cerr`; solutions are expected to
+///  be discarded or merely counted, so the search itself is what gets
+///  measured.
+/// @tparam F                       Callable type, taking the telemetry to be
+///                                 filled in.
+/// @param [in] name                Name of the search, to be printed.
+/// @param [in] f                   Backtracking function to be profiled.
+///
+template <typename F>
+void profile(const char *name, F f)
+try
+{
+    search_stats stats;
+
+    f(stats);
+    stats.report(std::cerr, name);
+    std::cerr << std::endl;
+}
+catch (...)
+{
+    std::cerr << "unknown exception in `" << __func__ << '`' << std::endl;
+    throw;
+}
+
+} // unnamed namespace
+
+///
+/// @brief Enters the program.
+/// @returns Whether or not the operation was successful.
+/// @retval EXIT_SUCCESS            Operation success.
+/// @retval EXIT_FAILURE            Operation failure.
+///
+int main()
+try
+{
+#if defined MODE_PRINT
+    backtrack_rec("");
+//  backtrack_stk("");
+//  backtrack_que(""); // WARN: uses lots of memory!
+//  backtrack_bfs(password_constraint<3, max_length>(), "", 16 << 20);
+//  backtrack_cmp(password_constraint<3, max_length>(), "");
+//  backtrack_ids(password_constraint<3, max_length>(), "");
+//  backtrack_frm(password_constraint<3, max_length>(), "");
+//  write_sink ws; backtrack_frm(password_constraint<3, max_length>(), "", ws);
+//  backtrack_ckp(password_constraint<3, max_length>(), "", "solutions.txt",
+//      "solutions.ckp");
+//  search_control ctl(10); backtrack_par(password_constraint<3, 5>(), "",
+//      false, 0, 3, &ctl);
+//  backtrack<stack_frontier>(candidate_problem<password_constraint<3, 5>>(),
+//      candidate_problem<password_constraint<3, 5>>().make_node(""),
+//      print_solution);
+//  backtrack_par(password_constraint<3, max_length>(), "", true);
+//  backtrack_shard(password_constraint<3, max_length>(), 0, 4);
+//  backtrack_procs(password_constraint<3, max_length>(), "", "solutions.txt",
+//      "/tmp", 4);
+//  shard_worker(password_constraint<3, max_length>(), "/tmp");
+//  backtrack_frm(dfa_constraint(password_spec(3, max_length)), "");
+//  backtrack<call_stack>(queens_problem(8), queens_problem(8).make_node(),
+//      print_solution);
+//  backtrack_luby(queens_problem(32), queens_problem(32).make_node(),
+//      print_solution, 1);
+//  backtrack<call_stack>(sudoku_problem<true>(),
+//      sudoku_problem<true>().make_node(hard_sudoku), print_solution);
+#elif defined MODE_BENCHMARK
+    benchmark("backtrack_rec", backtrack_rec);
+    benchmark("backtrack_stk", backtrack_stk);
+    benchmark("backtrack<call_stack>",
+        [](const std::string &start)
+        {
+            const candidate_problem<password_constraint<3, max_length>> p;
+
+            return backtrack<call_stack>(p, p.make_node(start),
+                print_solution);
+        });
+    benchmark("backtrack<bounded_frontier>",
+        [](const std::string &start)
+        {
+            const candidate_problem<password_constraint<3, max_length>> p;
+
+            return backtrack<bounded_frontier>(p, p.make_node(start),
+                print_solution);
+        });
+    benchmark("backtrack_frm (no lookahead)",
+        [](const std::string &start)
+        {
+            return backtrack_frm(
+                password_constraint<3, max_length, false>(), start);
+        });
+    benchmark("backtrack_frm",
+        [](const std::string &start)
+        {
+            return backtrack_frm(password_constraint<3, max_length>(), start);
+        });
+    benchmark("backtrack_memo (no lookahead)",
+        [](const std::string &start)
+        {
+            return backtrack_memo(
+                password_constraint<3, max_length, false>(), start);
+        });
+    benchmark("backtrack_frm (DFA)",
+        [](const std::string &start)
+        {
+            return backtrack_frm(
+                dfa_constraint(password_spec(3, max_length)), start);
+        });
+    benchmark("backtrack_frm (DFA, write_sink)",
+        [](const std::string &start)
+        {
+            write_sink ws;
+
+            std::cout.flush();
+            return backtrack_frm(
+                dfa_constraint(password_spec(3, max_length)), start, ws);
+        });
+    benchmark("backtrack_frm (DFA, counting_sink)",
+        [](const std::string &start)
+        {
+            counting_sink cs;
+
+            return backtrack_frm(
+                dfa_constraint(password_spec(3, max_length)), start, cs);
+        });
+    for (std::size_t levels: {1, 2, 3})
+        benchmark(("backtrack_sfx (write_sink, last " +
+            std::to_string(levels) + ")").c_str(),
+            [levels](const std::string &start)
+            {
+                write_sink ws;
+
+                std::cout.flush();
+                return backtrack_sfx(password_constraint<3, max_length>(),
+                    start, ws, levels);
+            });
+    benchmark("backtrack_bfs",
+        [](const std::string &start)
+        {
+            return backtrack_bfs(password_constraint<3, max_length>(), start);
+        });
+    benchmark("backtrack_cmp",
+        [](const std::string &start)
+        {
+            return backtrack_cmp(password_constraint<3, max_length>(), start);
+        });
+    benchmark("backtrack_par",
+        [](const std::string &start)
+        {
+            return backtrack_par(password_constraint<3, max_length>(), start);
+        });
+    benchmark_problem("N-Queens (n = 8)", queens_problem(8),
+        queens_problem(8).make_node());
+    benchmark_problem("N-Queens (n = 12)", queens_problem(12),
+        queens_problem(12).make_node());
+    benchmark_problem<stack_frontier>("N-Queens (n = 12, stack_frontier)",
+        queens_problem(12), queens_problem(12).make_node());
+    benchmark_problem("N-Queens (n = 32, first solution)", queens_problem(32),
+        queens_problem(32).make_node(), 1);
+    benchmark_first("N-Queens (n = 32, random order)", queens_problem(32),
+        queens_problem(32).make_node(),
+        std::numeric_limits<std::uintmax_t>::max());
+    benchmark_first("N-Queens (n = 32, random order, Luby restarts)",
+        queens_problem(32), queens_problem(32).make_node(), 256);
+    benchmark_problem("Sudoku (hard)", sudoku_problem<>(),
+        sudoku_problem<>().make_node(hard_sudoku));
+    benchmark_problem("Sudoku (hard, MRV)", sudoku_problem<true>(),
+        sudoku_problem<true>().make_node(hard_sudoku));
+    benchmark_problem("Sudoku (17 givens)", sudoku_problem<>(),
+        sudoku_problem<>().make_node(sparse_sudoku));
+    benchmark_problem("Sudoku (17 givens, MRV)", sudoku_problem<true>(),
+        sudoku_problem<true>().make_node(sparse_sudoku));
+    benchmark_problem("Sudoku (hard, MRV, first solution)",
+        sudoku_problem<true>(), sudoku_problem<true>().make_node(hard_sudoku),
+        1);
+    benchmark_problem("Sudoku (hard, MRV & LCV, first solution)",
+        sudoku_problem<true, true>(),
+        sudoku_problem<true, true>().make_node(hard_sudoku), 1);
+#elif defined MODE_COUNT
+    count(password_constraint<3, max_length>());
+#elif defined MODE_SAMPLE
+    sample(password_constraint<3, max_length>(), 10);
+#elif defined MODE_CHECK
+    check_problems();
+    check_shards();
+    check_candidates();
+#elif defined MODE_STATS
+    profile("backtrack<call_stack> (string_problem)",
+        [](search_stats &stats)
+        {
+            backtrack<call_stack>(string_problem(), std::string(),
+                [](const std::string &) {}, nullptr, &stats);
+        });
+    profile("backtrack<stack_frontier> (string_problem)",
+        [](search_stats &stats)
+        {
+            backtrack<stack_frontier>(string_problem(), std::string(),
+                [](const std::string &) {}, nullptr, &stats);
+        });
+    profile("backtrack<priority_frontier> (candidate_problem)",
+        [](search_stats &stats)
+        {
+            const candidate_problem<password_constraint<3, max_length>> p;
+
+            backtrack<priority_frontier>(p, p.make_node(""),
+                [](std::string_view) {}, nullptr, &stats);
+        });
+    profile("backtrack<bounded_frontier> (candidate_problem)",
+        [](search_stats &stats)
+        {
+            const candidate_problem<password_constraint<3, max_length>> p;
+
+            backtrack<bounded_frontier>(p, p.make_node(""),
+                [](std::string_view) {}, nullptr, &stats);
+        });
+    profile("backtrack_frm (no lookahead)",
+        [](search_stats &stats)
+        {
+            counting_sink cs;
+
+            backtrack_frm(password_constraint<3, max_length, false>(), "",
+                cs, nullptr, &stats);
+        });
+    profile("backtrack_frm",
+        [](search_stats &stats)
+        {
+            counting_sink cs;
+
+            backtrack_frm(password_constraint<3, max_length>(), "", cs,
+                nullptr, &stats);
+        });
+    profile("backtrack_frm (DFA)",
+        [](search_stats &stats)
+        {
+            counting_sink cs;
+
+            backtrack_frm(dfa_constraint(password_spec(3, max_length)), "",
+                cs, nullptr, &stats);
+        });
+    // last, since its frontier holds a whole level, and the peak RSS is that
+    // of the process
+    profile("backtrack<queue_frontier> (candidate_problem)",
+        [](search_stats &stats)
+        {
+            const candidate_problem<password_constraint<3, max_length>> p;
+
+            backtrack<queue_frontier>(p, p.make_node(""),
+                [](std::string_view) {}, nullptr, &stats);
+        });
+#endif
     return EXIT_SUCCESS;
 }
 catch (...)